@@ -0,0 +1,145 @@
+#include "hb-benchmark.hh"
+
+#include "hb-cache.hh"
+
+#include <vector>
+
+#define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
+
+/* Runs the glyph streams that shaping real text produces through the
+ * variants of hb_cache_t, the way the glyph-advance and -origin caches
+ * see them.  All variants hold 256 items. */
+
+struct test_input_t
+{
+  const char *font_path;
+  const char *text_path;
+} default_tests[] =
+{
+  {"perf/fonts/NotoNastaliqUrdu-Regular.ttf",
+   "perf/texts/fa-thelittleprince.txt"},
+
+  {"perf/fonts/Amiri-Regular.ttf",
+   "perf/texts/fa-thelittleprince.txt"},
+
+  {SUBSET_FONT_BASE_PATH "NotoSansDevanagari-Regular.ttf",
+   "perf/texts/hi-words.txt"},
+
+  {"perf/fonts/Roboto-Regular.ttf",
+   "perf/texts/en-thelittleprince.txt"},
+
+  {SUBSET_FONT_BASE_PATH "SourceSerifVariable-Roman.ttf",
+   "perf/texts/react-dom.txt"},
+};
+
+using direct_cache_t = hb_cache_t<16, 16, 8>;
+using two_way_cache_t = hb_cache_t<16, 16, 8, true, 2>;
+using four_way_cache_t = hb_cache_t<16, 16, 8, true, 4>;
+
+static std::vector<hb_codepoint_t>
+glyph_stream (const test_input_t &input)
+{
+  std::vector<hb_codepoint_t> glyphs;
+
+  hb_face_t *face = hb_benchmark_face_create_from_file_or_fail (input.font_path, 0);
+  assert (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  hb_buffer_t *buf = hb_buffer_create ();
+  const char *end;
+  while ((end = (const char *) memchr (text, '\n', text_length)))
+  {
+    hb_buffer_clear_contents (buf);
+    hb_buffer_add_utf8 (buf, text, text_length, 0, end - text);
+    hb_buffer_guess_segment_properties (buf);
+    hb_shape (font, buf, nullptr, 0);
+
+    unsigned len;
+    hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buf, &len);
+    for (unsigned i = 0; i < len; i++)
+      glyphs.push_back (info[i].codepoint);
+
+    unsigned skip = end - text + 1;
+    text_length -= skip;
+    text += skip;
+  }
+
+  hb_buffer_destroy (buf);
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+
+  return glyphs;
+}
+
+template <typename cache_t>
+static void BM_Cache (benchmark::State &state,
+		      const test_input_t &input)
+{
+  std::vector<hb_codepoint_t> glyphs = glyph_stream (input);
+  cache_t cache;
+
+  unsigned lookups = 0, misses = 0;
+  for (auto _ : state)
+  {
+    /* Start cold, like a new font would. */
+    cache.clear ();
+
+    unsigned sum = 0;
+    for (hb_codepoint_t glyph : glyphs)
+    {
+      unsigned v;
+      if (!cache.get (glyph, &v))
+      {
+	v = (glyph * 7u) & 0xFFFFu;
+	cache.set (glyph, v);
+	misses++;
+      }
+      sum += v;
+    }
+    lookups += glyphs.size ();
+    benchmark::DoNotOptimize (sum);
+  }
+
+  state.SetItemsProcessed (lookups);
+  if (lookups)
+    state.counters["hit_rate"] = 1. - (double) misses / lookups;
+}
+
+template <typename cache_t>
+static void test_cache (const char *cache_name,
+			const test_input_t &test_input)
+{
+  char name[1024] = "BM_Cache/";
+  const char *p;
+  strcat (name, cache_name);
+  strcat (name, "/");
+  p = strrchr (test_input.font_path, '/');
+  strcat (name, p ? p + 1 : test_input.font_path);
+  strcat (name, "/");
+  p = strrchr (test_input.text_path, '/');
+  strcat (name, p ? p + 1 : test_input.text_path);
+
+  benchmark::RegisterBenchmark (name, BM_Cache<cache_t>, test_input)
+   ->Unit(benchmark::kMicrosecond);
+}
+
+int main(int argc, char** argv)
+{
+  benchmark::Initialize(&argc, argv);
+
+  for (const auto &test_input : default_tests)
+  {
+    test_cache<direct_cache_t> ("direct", test_input);
+    test_cache<two_way_cache_t> ("2-way", test_input);
+    test_cache<four_way_cache_t> ("4-way", test_input);
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+}
@@ -9,6 +9,17 @@ static hb_variation_t default_variations[] = {
     hb_variation_t {HB_TAG_NONE, 0}
 };
 
+/* Several axes away from their defaults, as with animated UI text;
+ * exercises applying many gvar tuples per glyph. */
+static hb_variation_t many_variations[] = {
+    hb_variation_t {HB_TAG ('w','g','h','t'), 700},
+    hb_variation_t {HB_TAG ('w','d','t','h'), 80},
+    hb_variation_t {HB_TAG ('o','p','s','z'), 40},
+    hb_variation_t {HB_TAG ('G','R','A','D'), 50},
+    hb_variation_t {HB_TAG ('s','l','n','t'), -5},
+    hb_variation_t {HB_TAG_NONE, 0}
+};
+
 static unsigned max_num_glyphs = 0;
 static const char *text = " ";
 
@@ -16,16 +27,20 @@ static struct test_input_t
 {
   hb_variation_t *variations;
   const char *font_path;
+  bool variations_only; /* Skip the run without variations. */
 } default_tests[] =
 {
   {nullptr,            SUBSET_FONT_BASE_PATH "Roboto-Regular.ttf"},
   {default_variations, SUBSET_FONT_BASE_PATH "RobotoFlex-Variable.ttf"},
+  {many_variations,    SUBSET_FONT_BASE_PATH "RobotoFlex-Variable.ttf", true},
   {default_variations, SUBSET_FONT_BASE_PATH "SourceSansPro-Regular.otf"},
   {default_variations, SUBSET_FONT_BASE_PATH "AdobeVFPrototype.otf"},
   {default_variations, SUBSET_FONT_BASE_PATH "SourceSerifVariable-Roman.ttf"},
   {nullptr,            SUBSET_FONT_BASE_PATH "Comfortaa-Regular-new.ttf"},
   {nullptr,            SUBSET_FONT_BASE_PATH "NotoNastaliqUrdu-Regular.ttf"},
   {nullptr,            SUBSET_FONT_BASE_PATH "NotoSerifMyanmar-Regular.otf"},
+  {default_variations, SUBSET_FONT_BASE_PATH "MPLUS1-Variable.ttf"},
+  {nullptr,            "test/api/fonts/NotoSans-Bold.ttf"},
 };
 
 static test_input_t *tests = default_tests;
@@ -36,9 +51,14 @@ enum operation_t
   nominal_glyphs,
   glyph_h_advances,
   glyph_v_advances,
+  glyph_h_advances_text,
+  glyph_h_advances_text_large_cache,
   glyph_v_origins,
   glyph_extents,
   draw_glyph,
+  draw_glyph_outline_cache,
+  draw_glyph_gvar_decoded_cache,
+  draw_glyphs_packed,
   paint_glyph,
   load_face_and_shape,
 };
@@ -78,6 +98,50 @@ _hb_close_path (hb_draw_funcs_t *, void *draw_data, hb_draw_state_t *, void *)
   i += 1.0;
 }
 
+/* A stream of glyphs in text order: Zipf-distributed, with the most
+ * frequent glyphs scattered over the glyph range, the way they are in
+ * running text.  With thousands of glyphs in the font, as in CJK
+ * fonts, this uses far more distinct glyphs than alphabetic text. */
+static hb_codepoint_t *
+_glyph_stream_create (unsigned num_glyphs, unsigned length)
+{
+  unsigned *rank_to_glyph = (unsigned *) calloc (num_glyphs, sizeof (unsigned));
+  double *cumulative = (double *) calloc (num_glyphs, sizeof (double));
+  hb_codepoint_t *glyphs = (hb_codepoint_t *) calloc (length, sizeof (hb_codepoint_t));
+
+  uint32_t seed = 1;
+  auto random = [&] () { seed = seed * 1103515245u + 12345u; return seed >> 8; };
+
+  double total = 0;
+  for (unsigned r = 0; r < num_glyphs; r++)
+  {
+    rank_to_glyph[r] = r;
+    total += 1. / (r + 1);
+    cumulative[r] = total;
+  }
+  for (unsigned r = num_glyphs; r > 1; r--)
+  {
+    unsigned j = random () % r;
+    unsigned t = rank_to_glyph[r - 1]; rank_to_glyph[r - 1] = rank_to_glyph[j]; rank_to_glyph[j] = t;
+  }
+
+  for (unsigned i = 0; i < length; i++)
+  {
+    double x = (random () / (double) (1u << 24)) * total;
+    unsigned lo = 0, hi = num_glyphs - 1;
+    while (lo < hi)
+    {
+      unsigned mid = (lo + hi) / 2;
+      if (cumulative[mid] < x) lo = mid + 1; else hi = mid;
+    }
+    glyphs[i] = rank_to_glyph[lo];
+  }
+
+  free (cumulative);
+  free (rank_to_glyph);
+  return glyphs;
+}
+
 static hb_draw_funcs_t *
 _draw_funcs_create (void)
 {
@@ -100,6 +164,10 @@ static void BM_Font (benchmark::State &state,
   {
     hb_face_t *face = hb_benchmark_face_create_from_file_or_fail (test_input.font_path, 0);
     assert (face);
+    if (operation == draw_glyph_outline_cache)
+      hb_face_set_glyf_outline_cache_size (face, 4 << 20);
+    if (operation == draw_glyph_gvar_decoded_cache)
+      hb_face_set_gvar_decoded_cache_size (face, 64 << 20);
     num_glyphs = hb_face_get_glyph_count (face);
     if (max_num_glyphs && num_glyphs > max_num_glyphs)
       num_glyphs = max_num_glyphs;
@@ -186,6 +254,31 @@ static void BM_Font (benchmark::State &state,
       free (glyphs);
       break;
     }
+    case glyph_h_advances_text:
+    case glyph_h_advances_text_large_cache:
+    {
+      const unsigned length = 4096;
+      hb_codepoint_t *glyphs = _glyph_stream_create (num_glyphs, length);
+      hb_position_t *advances = (hb_position_t *) calloc (length, sizeof (hb_position_t));
+
+      if (operation == glyph_h_advances_text_large_cache)
+	hb_font_set_cache_policy (font, HB_FONT_CACHE_POLICY_LARGE);
+
+      for (auto _ : state)
+	hb_font_get_glyph_h_advances (font,
+				      length,
+				      glyphs, sizeof (*glyphs),
+				      advances, sizeof (*advances));
+
+      unsigned lookups, misses;
+      hb_font_get_advance_cache_stats (font, &lookups, &misses);
+      if (lookups)
+	state.counters["miss_rate"] = (double) misses / lookups;
+
+      free (advances);
+      free (glyphs);
+      break;
+    }
     case glyph_v_origins:
     {
       hb_codepoint_t *glyphs = (hb_codepoint_t *) calloc (num_glyphs, sizeof (hb_codepoint_t));
@@ -216,6 +309,8 @@ static void BM_Font (benchmark::State &state,
       break;
     }
     case draw_glyph:
+    case draw_glyph_outline_cache:
+    case draw_glyph_gvar_decoded_cache:
     {
       hb_draw_funcs_t *draw_funcs = _draw_funcs_create ();
       for (auto _ : state)
@@ -227,6 +322,36 @@ static void BM_Font (benchmark::State &state,
       hb_draw_funcs_destroy (draw_funcs);
       break;
     }
+    case draw_glyphs_packed:
+    {
+      std::vector<hb_codepoint_t> glyphs (num_glyphs);
+      for (unsigned gid = 0; gid < num_glyphs; ++gid)
+	glyphs[gid] = gid;
+      std::vector<uint8_t> verbs (1 << 16);
+      std::vector<float> points (1 << 18);
+      for (auto _ : state)
+      {
+	for (unsigned start = 0; start < num_glyphs;)
+	{
+	  unsigned verb_count = verbs.size ();
+	  unsigned point_count = points.size () / 2;
+	  unsigned n = hb_font_draw_glyphs_packed (font, num_glyphs - start,
+						   glyphs.data () + start, sizeof (glyphs[0]),
+						   &verb_count, verbs.data (),
+						   &point_count, points.data (),
+						   nullptr);
+	  if (!n)
+	  {
+	    /* Glyph larger than the whole buffer. */
+	    verbs.resize (verbs.size () * 2);
+	    points.resize (points.size () * 2);
+	    continue;
+	  }
+	  start += n;
+	}
+      }
+      break;
+    }
     case paint_glyph:
     {
       hb_paint_funcs_t *paint_funcs = hb_paint_funcs_create ();
@@ -284,7 +409,7 @@ static void test_backend (const char *backend,
   strcat (name, "/");
   const char *p = strrchr (test_input.font_path, '/');
   strcat (name, p ? p + 1 : test_input.font_path);
-  strcat (name, variations ? "/var" : "");
+  strcat (name, !variations ? "" : variations[0].tag && variations[1].tag ? "/vars" : "/var");
   strcat (name, "/");
   strcat (name, backend);
 
@@ -300,7 +425,7 @@ static void test_operation (operation_t op,
   for (unsigned i = 0; i < num_tests; i++)
   {
     auto& test_input = tests[i];
-    for (int variable = 0; variable < int (test_input.variations != nullptr) + 1; variable++)
+    for (int variable = test_input.variations_only; variable < int (test_input.variations != nullptr) + 1; variable++)
     {
       const hb_variation_t *variations = variable ? test_input.variations : nullptr;
       for (const char **backend = supported_backends; *backend; backend++)
@@ -392,7 +517,7 @@ int main(int argc, char** argv)
 	if (p) p++;
       }
     }
-    hb_variation_t *variations = num_variations ? (hb_variation_t *) calloc (num_variations, sizeof (hb_variation_t)) : nullptr;
+    hb_variation_t *variations = num_variations ? (hb_variation_t *) calloc (num_variations + 1, sizeof (hb_variation_t)) : nullptr;
     if (variations_str)
     {
       const char *p = variations_str;
@@ -423,9 +548,14 @@ int main(int argc, char** argv)
   TEST_OPERATION (nominal_glyphs, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_h_advances, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_v_advances, benchmark::kMicrosecond);
+  TEST_OPERATION (glyph_h_advances_text, benchmark::kMicrosecond);
+  TEST_OPERATION (glyph_h_advances_text_large_cache, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_v_origins, benchmark::kMicrosecond);
   TEST_OPERATION (glyph_extents, benchmark::kMicrosecond);
   TEST_OPERATION (draw_glyph, benchmark::kMillisecond);
+  TEST_OPERATION (draw_glyph_outline_cache, benchmark::kMillisecond);
+  TEST_OPERATION (draw_glyph_gvar_decoded_cache, benchmark::kMillisecond);
+  TEST_OPERATION (draw_glyphs_packed, benchmark::kMillisecond);
   TEST_OPERATION (paint_glyph, benchmark::kMillisecond);
   TEST_OPERATION (load_face_and_shape, benchmark::kMicrosecond);
 
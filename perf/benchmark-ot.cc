@@ -1,5 +1,7 @@
 #include "hb-benchmark.hh"
 
+#define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
+
 static void BM_hb_ot_tags_from_script_and_language (benchmark::State& state,
 						    hb_script_t script,
 						    const char *language_str) {
@@ -36,4 +38,51 @@ BENCHMARK_CAPTURE (BM_hb_ot_tags_from_script_and_language, LATIN en_US, HB_SCRIP
 BENCHMARK_CAPTURE (BM_hb_ot_tags_from_script_and_language, COMMON none, HB_SCRIPT_LATIN, nullptr);
 BENCHMARK_CAPTURE (BM_hb_ot_tags_from_script_and_language, LATIN none, HB_SCRIPT_LATIN, nullptr);
 
+static void BM_hb_ot_layout_get_glyph_class (benchmark::State& state,
+					      const char *font_path)
+{
+  hb_face_t *face = hb_benchmark_face_create_from_file_or_fail (font_path, 0);
+  assert (face);
+  unsigned num_glyphs = hb_face_get_glyph_count (face);
+
+  /* Query in a scrambled order, as shaping does, not sequentially. */
+  for (auto _ : state)
+    for (unsigned i = 0; i < num_glyphs; i++)
+    {
+      unsigned h = i * 0x9E3779B1u;
+      h ^= h >> 15;
+      h *= 0x85EBCA77u;
+      h ^= h >> 13;
+      benchmark::DoNotOptimize (hb_ot_layout_get_glyph_class (face, h % num_glyphs));
+    }
+
+  hb_face_destroy (face);
+}
+BENCHMARK_CAPTURE (BM_hb_ot_layout_get_glyph_class, Amiri, "perf/fonts/Amiri-Regular.ttf");
+BENCHMARK_CAPTURE (BM_hb_ot_layout_get_glyph_class, NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf");
+BENCHMARK_CAPTURE (BM_hb_ot_layout_get_glyph_class, Roboto, "perf/fonts/Roboto-Regular.ttf");
+BENCHMARK_CAPTURE (BM_hb_ot_layout_get_glyph_class, MPLUS1, SUBSET_FONT_BASE_PATH "MPLUS1-Variable.ttf");
+
+/* Exercises Coverage lookups: every glyph against every GSUB lookup. */
+static void BM_hb_ot_layout_lookup_would_substitute (benchmark::State& state,
+						     const char *font_path)
+{
+  hb_face_t *face = hb_benchmark_face_create_from_file_or_fail (font_path, 0);
+  assert (face);
+  unsigned num_glyphs = hb_face_get_glyph_count (face);
+  unsigned num_lookups = hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB);
+
+  for (auto _ : state)
+    for (unsigned lookup_index = 0; lookup_index < num_lookups; lookup_index++)
+      for (hb_codepoint_t g = 0; g < num_glyphs; g++)
+	benchmark::DoNotOptimize (hb_ot_layout_lookup_would_substitute (face, lookup_index,
+									&g, 1, false));
+
+  hb_face_destroy (face);
+}
+BENCHMARK_CAPTURE (BM_hb_ot_layout_lookup_would_substitute, Amiri, "perf/fonts/Amiri-Regular.ttf");
+BENCHMARK_CAPTURE (BM_hb_ot_layout_lookup_would_substitute, NotoNastaliqUrdu, "perf/fonts/NotoNastaliqUrdu-Regular.ttf");
+BENCHMARK_CAPTURE (BM_hb_ot_layout_lookup_would_substitute, Roboto, "perf/fonts/Roboto-Regular.ttf");
+BENCHMARK_CAPTURE (BM_hb_ot_layout_lookup_would_substitute, MPLUS1, SUBSET_FONT_BASE_PATH "MPLUS1-Variable.ttf");
+
 BENCHMARK_MAIN();
@@ -2,6 +2,8 @@
 
 #include <glib.h>
 
+#include <vector>
+
 #define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
 
 struct test_input_t
@@ -128,6 +130,88 @@ static void test_shaper (const char *shaper,
    ->Unit(benchmark::kMillisecond);
 }
 
+static void BM_ShapeBatch (benchmark::State &state,
+			   bool batch,
+			   const test_input_t &input)
+{
+  hb_font_t *font;
+  {
+    hb_face_t *face = hb_benchmark_face_create_from_file_or_fail (input.font_path, 0);
+    assert (face);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
+
+  hb_blob_t *text_blob = hb_blob_create_from_file_or_fail (input.text_path);
+  assert (text_blob);
+  unsigned text_length;
+  const char *text = hb_blob_get_data (text_blob, &text_length);
+
+  /* One buffer per line. */
+  std::vector<std::pair<const char *, unsigned>> lines;
+  {
+    const char *p = text, *end;
+    unsigned len = text_length;
+    while ((end = (const char *) memchr (p, '\n', len)))
+    {
+      lines.push_back ({p, (unsigned) (end - p)});
+      len -= end - p + 1;
+      p = end + 1;
+    }
+  }
+  std::vector<hb_buffer_t *> buffers;
+  for (unsigned i = 0; i < lines.size (); i++)
+    buffers.push_back (hb_buffer_create ());
+
+  for (auto _ : state)
+  {
+    for (unsigned i = 0; i < lines.size (); i++)
+    {
+      hb_buffer_t *buf = buffers[i];
+      hb_buffer_clear_contents (buf);
+      hb_buffer_add_utf8 (buf, lines[i].first, lines[i].second, 0, -1);
+      hb_buffer_guess_segment_properties (buf);
+    }
+
+    if (batch)
+    {
+      bool ret = hb_shape_batch (font, buffers.data (), buffers.size (), nullptr, 0, nullptr);
+      assert (ret);
+    }
+    else
+      for (hb_buffer_t *buf : buffers)
+      {
+	bool ret = hb_shape_full (font, buf, nullptr, 0, nullptr);
+	assert (ret);
+      }
+  }
+
+  for (hb_buffer_t *buf : buffers)
+    hb_buffer_destroy (buf);
+
+  hb_blob_destroy (text_blob);
+  hb_font_destroy (font);
+}
+
+static void test_batch (const test_input_t &test_input)
+{
+  for (bool batch : {false, true})
+  {
+    char name[1024] = "BM_ShapeBatch";
+    const char *p;
+    strcat (name, "/");
+    p = strrchr (test_input.font_path, '/');
+    strcat (name, p ? p + 1 : test_input.font_path);
+    strcat (name, "/");
+    p = strrchr (test_input.text_path, '/');
+    strcat (name, p ? p + 1 : test_input.text_path);
+    strcat (name, batch ? "/batch" : "/loop");
+
+    benchmark::RegisterBenchmark (name, BM_ShapeBatch, batch, test_input)
+     ->Unit(benchmark::kMillisecond);
+  }
+}
+
 static const char *font_file = nullptr;
 static const char *text_file = nullptr;
 
@@ -225,6 +309,13 @@ int main(int argc, char** argv)
       test_shaper (*shaper, test_input);
   }
 
+  if (tests == default_tests)
+    test_batch ({"perf/fonts/Roboto-Regular.ttf",
+		 "perf/texts/en-words.txt"});
+  else
+    for (unsigned i = 0; i < num_tests; i++)
+      test_batch (tests[i]);
+
   benchmark::RunSpecifiedBenchmarks();
   benchmark::Shutdown();
 }
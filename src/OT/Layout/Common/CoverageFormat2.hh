@@ -59,7 +59,7 @@ struct CoverageFormat2_4
 
   unsigned int get_coverage (hb_codepoint_t glyph_id) const
   {
-    const RangeRecord<Types> &range = rangeRecord.bsearch (glyph_id);
+    const RangeRecord<Types> &range = *rangeRecord.as_array ().bsearch_branchless (glyph_id, &Null (RangeRecord<Types>));
     return likely (range.first <= range.last)
          ? (unsigned int) range.value + (glyph_id - range.first)
          : NOT_COVERED;
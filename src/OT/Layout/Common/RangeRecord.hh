@@ -50,6 +50,9 @@ struct RangeRecord
 
   int cmp (hb_codepoint_t g) const
   { return g < first ? -1 : g <= last ? 0 : +1; }
+  /* Whether the whole range sorts before @g; cheaper than cmp() for
+   * branch-free searches. */
+  bool lt (hb_codepoint_t g) const { return last < g; }
 
   HB_INTERNAL static int cmp_range (const void *pa, const void *pb) {
     const RangeRecord *a = (const RangeRecord *) pa;
@@ -177,6 +177,8 @@ struct VARC
       table.destroy ();
     }
 
+    bool has_data () const { return table->has_data (); }
+
     bool
     get_path (hb_font_t *font, hb_codepoint_t gid, hb_draw_session_t &draw_session) const
     {
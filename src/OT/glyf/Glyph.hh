@@ -7,6 +7,7 @@
 #include "GlyphHeader.hh"
 #include "SimpleGlyph.hh"
 #include "CompositeGlyph.hh"
+#include "outline-cache.hh"
 
 
 namespace OT {
@@ -333,12 +334,24 @@ struct Glyph
     contour_point_vector_t &points = type == SIMPLE ? all_points : scratch.comp_points;
     unsigned old_length = points.length;
 
+    /* Components that are simple glyphs come from the outline cache, if
+     * the face has one; not for the subsetter, which wants statistics. */
+    glyf_impl::outline_cache_t *outline_cache = nullptr;
+    if (type == SIMPLE && depth > 0 && !phantom_only && !points_with_deltas && !head_maxp_info)
+      outline_cache = glyf_accelerator.get_outline_cache ();
+    bool cached = false;
+
     switch (type) {
     case SIMPLE:
       if (depth == 0 && head_maxp_info)
         head_maxp_info->maxContours = hb_max (head_maxp_info->maxContours, (unsigned) header->numberOfContours);
       if (depth > 0 && composite_contours)
         *composite_contours += (unsigned) header->numberOfContours;
+      if (outline_cache && outline_cache->get (gid, coords, all_points))
+      {
+	cached = true;
+	break;
+      }
       if (unlikely (!SimpleGlyph (*header, bytes).get_contour_points (all_points, phantom_only)))
 	return false;
       break;
@@ -353,8 +366,9 @@ struct Glyph
     }
 
     /* Init phantom points */
-    if (unlikely (!points.resize (points.length + PHANTOM_COUNT))) return false;
+    if (unlikely (!cached && !points.resize (points.length + PHANTOM_COUNT))) return false;
     hb_array_t<contour_point_t> phantoms = points.as_array ().sub_array (points.length - PHANTOM_COUNT, PHANTOM_COUNT);
+    if (!cached)
     {
       // Duplicated code.
       int lsb = 0;
@@ -380,7 +394,7 @@ struct Glyph
     }
 
 #ifndef HB_NO_VAR
-    if (hb_any (coords))
+    if (!cached && hb_any (coords))
     {
 #ifndef HB_NO_BEYOND_64K
       if (glyf_accelerator.GVAR->has_data ())
@@ -401,6 +415,9 @@ struct Glyph
     }
 #endif
 
+    if (outline_cache && !cached)
+      outline_cache->set (gid, coords, points.as_array ().sub_array (old_length));
+
     // mainly used by CompositeGlyph calculating new X/Y offset value so no need to extend it
     // with child glyphs' points
     if (points_with_deltas != nullptr && depth == 0 && type == COMPOSITE)
@@ -180,6 +180,7 @@ struct glyf_accelerator_t
 #ifndef HB_NO_VERTICAL
     vmtx = nullptr;
 #endif
+    outline_cache_size = 0;
     const OT::head &head = *face->table.head;
     if (!glyf::has_valid_glyf_format (face))
       /* Unknown format.  Leave num_glyphs=0, that takes care of disabling us. */
@@ -201,6 +202,8 @@ struct glyf_accelerator_t
 
     num_glyphs = hb_max (1u, loca_table.get_length () / (short_offset ? 2 : 4)) - 1;
     num_glyphs = hb_min (num_glyphs, face->get_num_glyphs ());
+
+    outline_cache_size = face->glyf_outline_cache_size;
   }
   ~glyf_accelerator_t ()
   {
@@ -211,6 +214,13 @@ struct glyf_accelerator_t
       hb_free (scratch);
     }
 
+    auto *cache = outline_cache.get_relaxed ();
+    if (cache)
+    {
+      cache->~outline_cache_t ();
+      hb_free (cache);
+    }
+
     glyf_table.destroy ();
   }
 
@@ -542,6 +552,41 @@ struct glyf_accelerator_t
     }
   }
 
+  /* Returns nullptr unless hb_face_set_glyf_outline_cache_size() was
+   * used on the face. */
+  glyf_impl::outline_cache_t *get_outline_cache () const
+  {
+    if (!outline_cache_size) return nullptr;
+  retry:
+    auto *cache = outline_cache.get_acquire ();
+    if (unlikely (!cache))
+    {
+      cache = (glyf_impl::outline_cache_t *) hb_calloc (1, sizeof (glyf_impl::outline_cache_t));
+      if (unlikely (!cache))
+	return nullptr;
+      cache = new (cache) glyf_impl::outline_cache_t (outline_cache_size);
+      if (unlikely (!outline_cache.cmpexch (nullptr, cache)))
+      {
+	cache->~outline_cache_t ();
+	hb_free (cache);
+	goto retry;
+      }
+    }
+    return cache;
+  }
+
+  /* See hb_face_get_glyf_outline_cache_stats(). */
+  void get_outline_cache_stats (unsigned *hits, unsigned *misses) const
+  {
+    if (auto *cache = outline_cache.get_acquire ())
+      cache->get_stats (hits, misses);
+    else
+    {
+      if (hits) *hits = 0;
+      if (misses) *misses = 0;
+    }
+  }
+
 #ifndef HB_NO_VAR
   const gvar_accelerator_t *gvar;
 #ifndef HB_NO_BEYOND_64K
@@ -559,6 +604,8 @@ struct glyf_accelerator_t
   hb_blob_ptr_t<loca> loca_table;
   hb_blob_ptr_t<glyf> glyf_table;
   mutable hb_atomic_t<hb_glyf_scratch_t *> cached_scratch;
+  unsigned outline_cache_size;
+  mutable hb_atomic_t<glyf_impl::outline_cache_t *> outline_cache;
 };
 
 
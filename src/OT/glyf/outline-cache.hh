@@ -0,0 +1,165 @@
+#ifndef OT_GLYF_OUTLINE_CACHE_HH
+#define OT_GLYF_OUTLINE_CACHE_HH
+
+
+#include "../../hb.hh"
+#include "../../hb-map.hh"
+#include "../../hb-mutex.hh"
+
+
+namespace OT {
+namespace glyf_impl {
+
+
+/* A bounded cache of decoded simple glyphs, with variations applied and
+ * phantom points appended, keyed by glyph and variation coordinates.
+ * When drawing or measuring composite glyphs, their simple components
+ * are copied from here instead of being decoded again.
+ *
+ * When full, entries are evicted in CLOCK (second-chance) order.
+ * See hb_face_set_glyf_outline_cache_size(). */
+struct outline_cache_t
+{
+  outline_cache_t (unsigned max_bytes_) : max_bytes (max_bytes_) {}
+  ~outline_cache_t ()
+  {
+    for (entry_t *entry : clock)
+      destroy_entry (entry);
+  }
+
+  struct entry_t
+  {
+    unsigned size () const
+    {
+      /* Approximate; includes the entry's share of the map and clock. */
+      return sizeof (*this) + 2 * sizeof (void *) + 16 +
+	     coords.allocated * sizeof (coords[0]) +
+	     points.allocated * sizeof (points[0]);
+    }
+
+    bool matches (hb_array_t<const int> coords_) const
+    { return coords.as_array () == coords_; }
+
+    uint64_t key;
+    bool referenced;
+    hb_vector_t<int> coords;
+    hb_vector_t<contour_point_t> points;
+  };
+
+  static uint64_t key_for (hb_codepoint_t gid, hb_array_t<const int> coords)
+  { return ((uint64_t) gid << 32) | coords.hash (); }
+
+  /* Appends the cached points of gid at coords to points. */
+  bool get (hb_codepoint_t gid, hb_array_t<const int> coords,
+	    contour_point_vector_t &points /* IN/OUT */)
+  {
+    hb_lock_t lock (mutex);
+
+    entry_t *entry = entries.get (key_for (gid, coords));
+    if (!entry || !entry->matches (coords))
+    {
+      misses++;
+      return false;
+    }
+
+    hits++;
+    entry->referenced = true;
+    points.extend (entry->points.as_array ());
+    return !points.in_error ();
+  }
+
+  void set (hb_codepoint_t gid, hb_array_t<const int> coords,
+	    hb_array_t<const contour_point_t> points)
+  {
+    unsigned size = sizeof (entry_t) + 2 * sizeof (void *) + 16 +
+		    coords.length * sizeof (coords[0]) +
+		    points.length * sizeof (points[0]);
+    if (size > max_bytes)
+      return;
+
+    hb_lock_t lock (mutex);
+
+    uint64_t key = key_for (gid, coords);
+    if (entries.has (key))
+      return; /* Another thread, or a hash collision; keep the old one. */
+
+    while (used + size > max_bytes && clock)
+      evict_one ();
+
+    entry_t *entry = (entry_t *) hb_calloc (1, sizeof (entry_t));
+    if (unlikely (!entry))
+      return;
+    entry = new (entry) entry_t ();
+    entry->key = key;
+    entry->coords.extend (coords);
+    entry->points.extend (points);
+    clock.push (entry);
+    if (unlikely (entry->coords.in_error () ||
+		  entry->points.in_error () ||
+		  clock.in_error () ||
+		  !entries.set (key, entry)))
+    {
+      if (!clock.in_error ())
+	clock.pop ();
+      clock.reset_error ();
+      destroy_entry (entry);
+      return;
+    }
+    used += entry->size ();
+  }
+
+  void get_stats (unsigned *hits_, unsigned *misses_)
+  {
+    hb_lock_t lock (mutex);
+
+    if (hits_) *hits_ = hits;
+    if (misses_) *misses_ = misses;
+  }
+
+  protected:
+
+  void evict_one ()
+  {
+    for (;;)
+    {
+      if (hand >= clock.length)
+	hand = 0;
+      entry_t *entry = clock[hand];
+      if (entry->referenced)
+      {
+	entry->referenced = false;
+	hand++;
+	continue;
+      }
+
+      entries.del (entry->key);
+      used -= entry->size ();
+      clock[hand] = clock.tail ();
+      clock.pop ();
+      destroy_entry (entry);
+      return;
+    }
+  }
+
+  static void destroy_entry (entry_t *entry)
+  {
+    entry->~entry_t ();
+    hb_free (entry);
+  }
+
+  hb_mutex_t mutex;
+  unsigned max_bytes;
+  unsigned used = 0;
+  unsigned hand = 0;
+  unsigned hits = 0;
+  unsigned misses = 0;
+  hb_hashmap_t<uint64_t, entry_t *> entries;
+  hb_vector_t<entry_t *> clock;
+};
+
+
+} /* namespace glyf_impl */
+} /* namespace OT */
+
+
+#endif /* OT_GLYF_OUTLINE_CACHE_HH */
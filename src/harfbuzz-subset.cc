@@ -8,6 +8,7 @@
 #include "hb-buffer.cc"
 #include "hb-common.cc"
 #include "hb-draw.cc"
+#include "hb-executor.cc"
 #include "hb-face-builder.cc"
 #include "hb-face.cc"
 #include "hb-fallback-shape.cc"
@@ -13,6 +13,7 @@
 #include "hb-directwrite-shape.cc"
 #include "hb-directwrite.cc"
 #include "hb-draw.cc"
+#include "hb-executor.cc"
 #include "hb-face-builder.cc"
 #include "hb-face.cc"
 #include "hb-fallback-shape.cc"
@@ -436,6 +436,66 @@ struct hb_sorted_array_t :
     }
     return false;
   }
+  /* Like bfind(), but branch-free: halves the range with conditional
+   * moves down to a few items, then counts the items less than @x with
+   * a linear loop the compiler can vectorize.  Avoids the mispredicts
+   * of bsearch on the hot Coverage and ClassDef lookups.  Arrays shorter
+   * than HB_BSEARCH_BRANCHLESS_MIN_LENGTH go through bfind() instead,
+   * whose early exit wins there. */
+  template <typename T>
+  bool bfind_branchless (const T &x, unsigned int *i,
+			 hb_not_found_t not_found = HB_NOT_FOUND_DONT_STORE,
+			 unsigned int to_store = (unsigned int) -1) const
+  {
+    if (this->length < HB_BSEARCH_BRANCHLESS_MIN_LENGTH)
+      return bfind (x, i, not_found, to_store);
+
+    const Type *base = this->arrayZ;
+    unsigned n = this->length;
+    while (n > 8)
+    {
+      unsigned half = n / 2;
+      base = item_lt (base[half], x) ? base + half : base;
+      n -= half;
+    }
+    unsigned pos = base - this->arrayZ;
+    for (unsigned j = 0; j < n; j++)
+      pos += item_lt (base[j], x);
+
+    if (pos < this->length && !this->arrayZ[pos].cmp (x))
+    {
+      *i = pos;
+      return true;
+    }
+    switch (not_found)
+    {
+      case HB_NOT_FOUND_DONT_STORE:
+	break;
+
+      case HB_NOT_FOUND_STORE:
+	*i = to_store;
+	break;
+
+      case HB_NOT_FOUND_STORE_CLOSEST:
+	*i = pos;
+	break;
+    }
+    return false;
+  }
+  template <typename T>
+  const Type *bsearch_branchless (const T &x, const Type *not_found = nullptr) const
+  {
+    unsigned int i;
+    return bfind_branchless (x, &i) ? &this->arrayZ[i] : not_found;
+  }
+  private:
+  template <typename V, typename T>
+  static auto _item_lt (const V &item, const T &x, hb_priority<1>) HB_AUTO_RETURN (item.lt (x))
+  template <typename V, typename T>
+  static auto _item_lt (const V &item, const T &x, hb_priority<0>) HB_AUTO_RETURN (item.cmp (x) > 0)
+  template <typename T>
+  static bool item_lt (const Type &item, const T &x) { return _item_lt (item, x, hb_prioritize); }
+  public:
   template <typename T, typename ...Ts>
   bool bsearch_impl (const T &x, unsigned *pos, Ts... ds) const
   {
@@ -28,6 +28,7 @@
 #define HB_CACHE_HH
 
 #include "hb.hh"
+#include "hb-machinery.hh" /* HB_VAR_ARRAY */
 
 
 /* Implements a lockfree and thread-safe cache for int->int functions,
@@ -55,25 +56,41 @@
  *
  * Cache operations (storage and retrieval) involve just a few
  * arithmetic operations and a single memory access.
+ *
+ * With more than one way, the cache is set-associative instead: the
+ * index picks a set of that many consecutive items, any of which can
+ * hold the key, so keys that share their low bits don't keep evicting
+ * each other.  Lookups check every item of the set; stores move the
+ * items of the set down by one, dropping the oldest, and put the new
+ * one first.  Each item is still self-contained, so this stays
+ * lock-free: concurrent stores can at worst drop or duplicate items.
+ * It costs a few more bits of each item, since fewer of the key bits
+ * index the array.
  */
 
 template <unsigned int key_bits=16,
 	 unsigned int value_bits=8 + 32 - key_bits,
 	 unsigned int cache_bits=8,
-	 bool thread_safe=true>
+	 bool thread_safe=true,
+	 unsigned int ways=1>
 struct hb_cache_t
 {
+  static_assert ((ways == 1 || ways == 2 || ways == 4), "");
+  static constexpr unsigned way_bits = ways == 4 ? 2 : ways == 2 ? 1 : 0;
+  static constexpr unsigned set_bits = cache_bits - way_bits;
+
   using item_t = typename std::conditional<thread_safe,
-					   typename std::conditional<key_bits + value_bits - cache_bits <= 16,
+					   typename std::conditional<key_bits + value_bits - set_bits <= 16,
 								     hb_atomic_t<unsigned short>,
 								     hb_atomic_t<unsigned int>>::type,
-					   typename std::conditional<key_bits + value_bits - cache_bits <= 16,
+					   typename std::conditional<key_bits + value_bits - set_bits <= 16,
 								     unsigned short,
 								     unsigned int>::type
 					  >::type;
 
-  static_assert ((key_bits >= cache_bits), "");
-  static_assert ((key_bits + value_bits <= cache_bits + 8 * sizeof (item_t)), "");
+  static_assert ((cache_bits >= way_bits), "");
+  static_assert ((key_bits >= set_bits), "");
+  static_assert ((key_bits + value_bits <= set_bits + 8 * sizeof (item_t)), "");
 
   static constexpr unsigned MAX_VALUE = (1u << value_bits) - 1;
 
@@ -85,12 +102,112 @@ struct hb_cache_t
       v = -1;
   }
 
+  HB_HOT
+  bool get (unsigned int key, unsigned int *value) const
+  {
+    unsigned int k = (key & ((1u<<set_bits)-1)) << way_bits;
+    /* Check all ways without branching; which one hits is hard to predict. */
+    unsigned int found = 0;
+    unsigned int found_v = 0;
+    for (unsigned int i = 0; i < ways; i++)
+    {
+      unsigned int v = values[k + i];
+      unsigned int hit = (v >> value_bits) == (key >> set_bits);
+      if (key_bits + value_bits - set_bits == 8 * sizeof (item_t))
+	hit &= v != (unsigned int) -1;
+      unsigned int mask = 0u - hit;
+      found_v |= v & mask;
+      found |= mask;
+    }
+    if (!found)
+      return false;
+    *value = found_v & ((1u<<value_bits)-1);
+    return true;
+  }
+
+  HB_HOT
+  void set (unsigned int key, unsigned int value)
+  {
+    if (unlikely ((key >> key_bits) || (value >> value_bits)))
+      return; /* Overflows */
+    set_unchecked (key, value);
+  }
+
+  HB_HOT
+  void set_unchecked (unsigned int key, unsigned int value)
+  {
+    unsigned int k = (key & ((1u<<set_bits)-1)) << way_bits;
+    unsigned int v = ((key>>set_bits)<<value_bits) | value;
+    for (unsigned int i = ways - 1; i; i--)
+      values[k + i] = (unsigned int) values[k + i - 1];
+    values[k] = v;
+  }
+
+  private:
+  item_t values[1u<<cache_bits];
+};
+
+
+/* Like hb_cache_t, but with the number of cache bits chosen when the
+ * cache is created, for caches whose size is a per-object setting.
+ * The items follow the struct in the same allocation, so these can
+ * only be made with create() and released with destroy().
+ *
+ * Since fewer key bits are stored in each item as the cache grows,
+ * items are sized for the smallest cache allowed. */
+
+template <unsigned int key_bits=16,
+	 unsigned int value_bits=8 + 32 - key_bits,
+	 unsigned int min_cache_bits=8,
+	 unsigned int max_cache_bits=key_bits,
+	 bool thread_safe=true>
+struct hb_sized_cache_t
+{
+  using item_t = typename std::conditional<thread_safe,
+					   typename std::conditional<key_bits + value_bits - min_cache_bits <= 16,
+								     hb_atomic_t<unsigned short>,
+								     hb_atomic_t<unsigned int>>::type,
+					   typename std::conditional<key_bits + value_bits - min_cache_bits <= 16,
+								     unsigned short,
+								     unsigned int>::type
+					  >::type;
+
+  static_assert ((min_cache_bits <= max_cache_bits), "");
+  static_assert ((key_bits >= max_cache_bits), "");
+  static_assert ((key_bits + value_bits <= min_cache_bits + 8 * sizeof (item_t)), "");
+
+  static constexpr unsigned MAX_VALUE = (1u << value_bits) - 1;
+
+  static hb_sized_cache_t *create (unsigned int cache_bits)
+  {
+    cache_bits = hb_clamp (cache_bits, min_cache_bits, max_cache_bits);
+    size_t size = sizeof (hb_sized_cache_t) + ((sizeof (item_t) << cache_bits) - sizeof (item_t));
+    hb_sized_cache_t *cache = (hb_sized_cache_t *) hb_malloc (size);
+    if (unlikely (!cache))
+      return nullptr;
+    cache->cache_bits = cache_bits;
+    for (unsigned i = 0; i < 1u << cache_bits; i++)
+      new (&cache->values[i]) item_t;
+    cache->clear ();
+    return cache;
+  }
+  static void destroy (hb_sized_cache_t *cache) { hb_free (cache); }
+
+  unsigned int get_cache_bits () const { return cache_bits; }
+  unsigned int get_size () const { return sizeof (item_t) << cache_bits; }
+
+  void clear ()
+  {
+    for (unsigned i = 0; i < 1u << cache_bits; i++)
+      values[i] = -1;
+  }
+
   HB_HOT
   bool get (unsigned int key, unsigned int *value) const
   {
     unsigned int k = key & ((1u<<cache_bits)-1);
     unsigned int v = values[k];
-    if ((key_bits + value_bits - cache_bits == 8 * sizeof (item_t) && v == (unsigned int) -1) ||
+    if ((key_bits + value_bits - min_cache_bits == 8 * sizeof (item_t) && v == (unsigned int) -1) ||
 	(v >> value_bits) != (key >> cache_bits))
       return false;
     *value = v & ((1u<<value_bits)-1);
@@ -114,7 +231,10 @@ struct hb_cache_t
   }
 
   private:
-  item_t values[1u<<cache_bits];
+  hb_sized_cache_t () = delete;
+
+  unsigned int cache_bits;
+  item_t values[HB_VAR_ARRAY];
 };
 
 
@@ -189,6 +189,7 @@
 #ifdef HB_MINIMIZE_MEMORY_USAGE
 #define HB_NO_GDEF_CACHE
 #define HB_NO_OT_LAYOUT_LOOKUP_CACHE
+#define HB_NO_OT_LAYOUT_SUBTABLE_INDEX
 #define HB_NO_OT_FONT_CMAP_CACHE
 #endif
 
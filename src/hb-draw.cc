@@ -548,4 +548,101 @@ hb_draw_extents_get_funcs ()
 }
 
 
+static void
+hb_draw_packed_move_to (hb_draw_funcs_t *dfuncs HB_UNUSED,
+			void *data,
+			hb_draw_state_t *st HB_UNUSED,
+			float to_x, float to_y,
+			void *user_data HB_UNUSED)
+{
+  hb_draw_packed_t *packed = (hb_draw_packed_t *) data;
+
+  packed->move_to (to_x, to_y);
+}
+
+static void
+hb_draw_packed_line_to (hb_draw_funcs_t *dfuncs HB_UNUSED,
+			void *data,
+			hb_draw_state_t *st HB_UNUSED,
+			float to_x, float to_y,
+			void *user_data HB_UNUSED)
+{
+  hb_draw_packed_t *packed = (hb_draw_packed_t *) data;
+
+  packed->line_to (to_x, to_y);
+}
+
+static void
+hb_draw_packed_quadratic_to (hb_draw_funcs_t *dfuncs HB_UNUSED,
+			     void *data,
+			     hb_draw_state_t *st HB_UNUSED,
+			     float control_x, float control_y,
+			     float to_x, float to_y,
+			     void *user_data HB_UNUSED)
+{
+  hb_draw_packed_t *packed = (hb_draw_packed_t *) data;
+
+  packed->quadratic_to (control_x, control_y, to_x, to_y);
+}
+
+static void
+hb_draw_packed_cubic_to (hb_draw_funcs_t *dfuncs HB_UNUSED,
+			 void *data,
+			 hb_draw_state_t *st HB_UNUSED,
+			 float control1_x, float control1_y,
+			 float control2_x, float control2_y,
+			 float to_x, float to_y,
+			 void *user_data HB_UNUSED)
+{
+  hb_draw_packed_t *packed = (hb_draw_packed_t *) data;
+
+  packed->cubic_to (control1_x, control1_y, control2_x, control2_y, to_x, to_y);
+}
+
+static void
+hb_draw_packed_close_path (hb_draw_funcs_t *dfuncs HB_UNUSED,
+			   void *data,
+			   hb_draw_state_t *st HB_UNUSED,
+			   void *user_data HB_UNUSED)
+{
+  hb_draw_packed_t *packed = (hb_draw_packed_t *) data;
+
+  packed->close_path ();
+}
+
+static inline void free_static_draw_packed_funcs ();
+
+static struct hb_draw_packed_funcs_lazy_loader_t : hb_draw_funcs_lazy_loader_t<hb_draw_packed_funcs_lazy_loader_t>
+{
+  static hb_draw_funcs_t *create ()
+  {
+    hb_draw_funcs_t *funcs = hb_draw_funcs_create ();
+
+    hb_draw_funcs_set_move_to_func (funcs, hb_draw_packed_move_to, nullptr, nullptr);
+    hb_draw_funcs_set_line_to_func (funcs, hb_draw_packed_line_to, nullptr, nullptr);
+    hb_draw_funcs_set_quadratic_to_func (funcs, hb_draw_packed_quadratic_to, nullptr, nullptr);
+    hb_draw_funcs_set_cubic_to_func (funcs, hb_draw_packed_cubic_to, nullptr, nullptr);
+    hb_draw_funcs_set_close_path_func (funcs, hb_draw_packed_close_path, nullptr, nullptr);
+
+    hb_draw_funcs_make_immutable (funcs);
+
+    hb_atexit (free_static_draw_packed_funcs);
+
+    return funcs;
+  }
+} static_draw_packed_funcs;
+
+static inline
+void free_static_draw_packed_funcs ()
+{
+  static_draw_packed_funcs.free_instance ();
+}
+
+hb_draw_funcs_t *
+hb_draw_packed_get_funcs ()
+{
+  return static_draw_packed_funcs.get_unconst ();
+}
+
+
 #endif
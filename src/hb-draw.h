@@ -72,6 +72,30 @@ typedef struct hb_draw_state_t {
  */
 #define HB_DRAW_STATE_DEFAULT {0, 0.f, 0.f, 0.f, 0.f, {0}, {0}, {0}, {0}, {0}, {0}, {0}}
 
+/**
+ * hb_draw_verb_t:
+ * @HB_DRAW_VERB_MOVE_TO: Starts a new contour; takes one point.
+ * @HB_DRAW_VERB_LINE_TO: A straight line; takes one point.
+ * @HB_DRAW_VERB_QUADRATIC_TO: A quadratic Bézier curve; takes two points,
+ *   the control point and the target point.
+ * @HB_DRAW_VERB_CUBIC_TO: A cubic Bézier curve; takes three points,
+ *   the two control points and the target point.
+ * @HB_DRAW_VERB_CLOSE_PATH: Closes the current contour; takes no points.
+ *
+ * The drawing commands of a packed outline, as produced by
+ * hb_font_draw_glyphs_packed().  They correspond one-to-one to the
+ * callbacks of #hb_draw_funcs_t.
+ *
+ * Since: REPLACEME
+ **/
+typedef enum {
+  HB_DRAW_VERB_MOVE_TO,
+  HB_DRAW_VERB_LINE_TO,
+  HB_DRAW_VERB_QUADRATIC_TO,
+  HB_DRAW_VERB_CUBIC_TO,
+  HB_DRAW_VERB_CLOSE_PATH
+} hb_draw_verb_t;
+
 
 /**
  * hb_draw_funcs_t:
@@ -28,6 +28,84 @@
 #include "hb.hh"
 
 
+/*
+ * hb_draw_packed_t
+ *
+ * Appends drawing commands to caller-owned verb and point arrays; see
+ * hb_font_draw_glyphs_packed().  hb_draw_packed_get_funcs() draws
+ * here.
+ */
+
+struct hb_draw_packed_t
+{
+  hb_draw_packed_t (uint8_t *verbs_, unsigned verb_capacity_,
+		    float *points_, unsigned point_capacity_) :
+    verbs (verbs_), verb_capacity (verb_capacity_),
+    points (points_), point_capacity (point_capacity_) {}
+
+  bool in_error () const { return error; }
+
+  HB_ALWAYS_INLINE
+  void add (hb_draw_verb_t verb, unsigned num_points, const float *coords)
+  {
+    if (unlikely (verb_count >= verb_capacity ||
+		  num_points > point_capacity - point_count))
+    {
+      error = true;
+      return;
+    }
+    verbs[verb_count++] = verb;
+    hb_memcpy (points + 2 * point_count, coords, 2 * num_points * sizeof (float));
+    point_count += num_points;
+  }
+
+  void move_to (float to_x, float to_y)
+  {
+    float coords[] = {to_x, to_y};
+    add (HB_DRAW_VERB_MOVE_TO, 1, coords);
+  }
+  void line_to (float to_x, float to_y)
+  {
+    float coords[] = {to_x, to_y};
+    add (HB_DRAW_VERB_LINE_TO, 1, coords);
+  }
+  void quadratic_to (float control_x, float control_y,
+		     float to_x, float to_y)
+  {
+    float coords[] = {control_x, control_y, to_x, to_y};
+    add (HB_DRAW_VERB_QUADRATIC_TO, 2, coords);
+  }
+  void cubic_to (float control1_x, float control1_y,
+		 float control2_x, float control2_y,
+		 float to_x, float to_y)
+  {
+    float coords[] = {control1_x, control1_y, control2_x, control2_y, to_x, to_y};
+    add (HB_DRAW_VERB_CUBIC_TO, 3, coords);
+  }
+  void close_path ()
+  {
+    add (HB_DRAW_VERB_CLOSE_PATH, 0, nullptr);
+  }
+
+  /* Drops everything after the given counts; used to undo a glyph that
+   * did not fit. */
+  void truncate (unsigned verb_count_, unsigned point_count_)
+  {
+    verb_count = verb_count_;
+    point_count = point_count_;
+    error = false;
+  }
+
+  uint8_t *verbs;
+  unsigned verb_count = 0;
+  unsigned verb_capacity;
+  float *points; /* x,y pairs */
+  unsigned point_count = 0;
+  unsigned point_capacity;
+  bool error = false;
+};
+
+
 /*
  * hb_draw_funcs_t
  */
@@ -229,5 +307,8 @@ struct hb_draw_session_t
 HB_INTERNAL hb_draw_funcs_t *
 hb_draw_extents_get_funcs ();
 
+HB_INTERNAL hb_draw_funcs_t *
+hb_draw_packed_get_funcs ();
+
 
 #endif /* HB_DRAW_HH */
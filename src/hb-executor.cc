@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb-executor.hh"
+
+
+/**
+ * SECTION:hb-executor
+ * @title: hb-executor
+ * @short_description: Running independent tasks on the client's threads
+ * @include: hb.h
+ *
+ * HarfBuzz does not create threads of its own.  Instead, operations
+ * that can split their work into independent tasks accept an
+ * #hb_executor_t, which wraps a client callback that runs a batch of
+ * tasks and waits for all of them to finish.  This way a single
+ * thread pool owned by the application can serve HarfBuzz as well as
+ * every other library it uses.
+ *
+ * The empty executor runs tasks one after another on the calling
+ * thread, which is also what happens when no executor is given.
+ **/
+
+
+/**
+ * hb_executor_create:
+ * @func: the callback that runs tasks
+ * @user_data: data to pass to @func
+ * @destroy: (nullable): a callback to call when @user_data is not needed anymore
+ *
+ * Creates a new executor that runs tasks through @func.
+ *
+ * Return value: (transfer full): The new #hb_executor_t
+ *
+ * Since: REPLACEME
+ **/
+hb_executor_t *
+hb_executor_create (hb_executor_run_func_t  func,
+		    void                   *user_data,
+		    hb_destroy_func_t       destroy)
+{
+  hb_executor_t *executor;
+
+  if (unlikely (!func) ||
+      !(executor = hb_object_create<hb_executor_t> ()))
+  {
+    if (destroy)
+      destroy (user_data);
+    return hb_executor_get_empty ();
+  }
+
+  executor->func = func;
+  executor->user_data = user_data;
+  executor->destroy = destroy;
+
+  return executor;
+}
+
+/**
+ * hb_executor_get_empty:
+ *
+ * Fetches the singleton empty #hb_executor_t, which runs tasks one
+ * after another on the calling thread.
+ *
+ * Return value: (transfer full): The empty #hb_executor_t
+ *
+ * Since: REPLACEME
+ **/
+hb_executor_t *
+hb_executor_get_empty ()
+{
+  return const_cast<hb_executor_t *> (&Null (hb_executor_t));
+}
+
+/**
+ * hb_executor_reference: (skip)
+ * @executor: An executor
+ *
+ * Increases the reference count on an executor.
+ *
+ * Return value: (transfer full): The executor
+ *
+ * Since: REPLACEME
+ **/
+hb_executor_t *
+hb_executor_reference (hb_executor_t *executor)
+{
+  return hb_object_reference (executor);
+}
+
+/**
+ * hb_executor_destroy: (skip)
+ * @executor: An executor
+ *
+ * Decreases the reference count on an executor.  When the
+ * reference count reaches zero, the executor is destroyed and
+ * its user data released.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_executor_destroy (hb_executor_t *executor)
+{
+  if (!hb_object_destroy (executor)) return;
+
+  hb_free (executor);
+}
+
+/**
+ * hb_executor_set_user_data: (skip)
+ * @executor: An executor
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified executor.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_executor_set_user_data (hb_executor_t      *executor,
+			   hb_user_data_key_t *key,
+			   void *              data,
+			   hb_destroy_func_t   destroy,
+			   hb_bool_t           replace)
+{
+  return hb_object_set_user_data (executor, key, data, destroy, replace);
+}
+
+/**
+ * hb_executor_get_user_data: (skip)
+ * @executor: An executor
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified executor.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: REPLACEME
+ **/
+void *
+hb_executor_get_user_data (const hb_executor_t *executor,
+			   hb_user_data_key_t  *key)
+{
+  return hb_object_get_user_data (executor, key);
+}
+
+/**
+ * hb_executor_run:
+ * @executor: An executor
+ * @task: the function to call for each task
+ * @task_data: data to pass to @task
+ * @num_tasks: the number of tasks
+ *
+ * Runs @num_tasks tasks through @executor, calling @task once with
+ * each index from 0 to @num_tasks - 1, and returns once all of them
+ * have finished.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_executor_run (hb_executor_t           *executor,
+		 hb_executor_task_func_t  task,
+		 void                    *task_data,
+		 unsigned int             num_tasks)
+{
+  executor->run (task, task_data, num_tasks);
+}
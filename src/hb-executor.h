@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#if !defined(HB_H_IN) && !defined(HB_NO_SINGLE_HEADER_ERROR)
+#error "Include <hb.h> instead."
+#endif
+
+#ifndef HB_EXECUTOR_H
+#define HB_EXECUTOR_H
+
+#include "hb-common.h"
+
+HB_BEGIN_DECLS
+
+
+/**
+ * hb_executor_t:
+ *
+ * Data type for running batches of independent tasks on behalf of
+ * HarfBuzz, for example on a thread pool owned by the application.
+ *
+ * HarfBuzz never creates threads itself.  Operations that can split
+ * their work into independent tasks accept an executor, and hand the
+ * tasks to it.
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_executor_t hb_executor_t;
+
+/**
+ * hb_executor_task_func_t:
+ * @task_data: the @task_data passed to the #hb_executor_run_func_t
+ * @task_index: the index of the task to run
+ *
+ * A unit of work handed to an #hb_executor_t.
+ *
+ * Since: REPLACEME
+ **/
+typedef void (*hb_executor_task_func_t) (void         *task_data,
+					 unsigned int  task_index);
+
+/**
+ * hb_executor_run_func_t:
+ * @executor: the executor
+ * @task: the function to call for each task
+ * @task_data: data to pass to @task
+ * @num_tasks: the number of tasks; @task must be called once with each
+ * index from 0 to @num_tasks - 1
+ * @user_data: the user data passed to hb_executor_create()
+ *
+ * A callback that runs a batch of independent tasks and returns once
+ * all of them have finished.  The tasks may run concurrently and in
+ * any order, including on the calling thread.
+ *
+ * Since: REPLACEME
+ **/
+typedef void (*hb_executor_run_func_t) (hb_executor_t           *executor,
+					hb_executor_task_func_t  task,
+					void                    *task_data,
+					unsigned int             num_tasks,
+					void                    *user_data);
+
+
+HB_EXTERN hb_executor_t *
+hb_executor_create (hb_executor_run_func_t  func,
+		    void                   *user_data,
+		    hb_destroy_func_t       destroy);
+
+HB_EXTERN hb_executor_t *
+hb_executor_get_empty (void);
+
+HB_EXTERN hb_executor_t *
+hb_executor_reference (hb_executor_t *executor);
+
+HB_EXTERN void
+hb_executor_destroy (hb_executor_t *executor);
+
+HB_EXTERN hb_bool_t
+hb_executor_set_user_data (hb_executor_t      *executor,
+			   hb_user_data_key_t *key,
+			   void *              data,
+			   hb_destroy_func_t   destroy,
+			   hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_executor_get_user_data (const hb_executor_t *executor,
+			   hb_user_data_key_t  *key);
+
+HB_EXTERN void
+hb_executor_run (hb_executor_t           *executor,
+		 hb_executor_task_func_t  task,
+		 void                    *task_data,
+		 unsigned int             num_tasks);
+
+
+HB_END_DECLS
+
+#endif /* HB_EXECUTOR_H */
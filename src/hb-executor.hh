@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#ifndef HB_EXECUTOR_HH
+#define HB_EXECUTOR_HH
+
+#include "hb.hh"
+
+
+struct hb_executor_t
+{
+  hb_object_header_t header;
+
+  hb_executor_run_func_t func;
+  void *user_data;
+  hb_destroy_func_t destroy;
+
+  ~hb_executor_t () { if (destroy) destroy (user_data); }
+
+  /* Whether tasks may actually run concurrently.  Callers use this to
+   * skip the bookkeeping parallel execution needs when it won't. */
+  bool is_concurrent () const { return func; }
+
+  void run (hb_executor_task_func_t task, void *task_data, unsigned num_tasks)
+  {
+    if (!num_tasks) return;
+
+    if (func)
+    {
+      func (this, task, task_data, num_tasks, user_data);
+      return;
+    }
+
+    for (unsigned i = 0; i < num_tasks; i++)
+      task (task_data, i);
+  }
+};
+
+
+#endif /* HB_EXECUTOR_HH */
@@ -32,7 +32,10 @@
 #include "hb-blob.hh"
 #include "hb-open-file.hh"
 #include "hb-ot-face.hh"
+#include "hb-ot-layout.hh"
+#include "hb-executor.hh"
 #include "hb-ot-cmap-table.hh"
+#include "hb-ot-glyf-table.hh"
 
 #ifdef HAVE_FREETYPE
 #include "hb-ft.h"
@@ -145,6 +148,10 @@ hb_face_create_for_tables (hb_reference_table_func_t  reference_table_func,
 
   face->num_glyphs = -1;
 
+#ifndef HB_NO_SHAPER
+  face->shape_plans_capacity = HB_SHAPE_PLAN_CACHE_CAPACITY_DEFAULT;
+#endif
+
   face->data.init0 (face);
   face->table.init0 (face);
 
@@ -579,12 +586,10 @@ hb_face_destroy (hb_face_t *face)
   if (!hb_object_destroy (face)) return;
 
 #ifndef HB_NO_SHAPER
-  for (hb_face_t::plan_node_t *node = face->shape_plans; node; )
+  if (hb_shape_plan_cache_t *shape_plans = face->shape_plans.get_relaxed ())
   {
-    hb_face_t::plan_node_t *next = node->next;
-    hb_shape_plan_destroy (node->shape_plan);
-    hb_free (node);
-    node = next;
+    shape_plans->~hb_shape_plan_cache_t ();
+    hb_free (shape_plans);
   }
 #endif
 
@@ -1013,3 +1018,215 @@ hb_face_collect_variation_unicodes (hb_face_t *face,
   face->table.cmap->collect_variation_unicodes (variation_selector, out);
 }
 #endif
+
+
+/**
+ * hb_face_warm:
+ * @face: A face object
+ * @executor: (nullable): The executor to build lookup accelerators on
+ *
+ * Loads the tables of @face and builds the accelerators HarfBuzz
+ * otherwise creates lazily on first use, including those of every
+ * GSUB and GPOS lookup.  This makes the first shaping request on a
+ * newly loaded face as fast as later ones.  To only prepare what a
+ * given script, language and set of features need, use
+ * hb_font_warm() instead.
+ *
+ * If @executor is not `NULL`, the lookup accelerators are built as
+ * separate tasks on it.
+ *
+ * It is safe to call this function from any thread, including while
+ * @face is being used for shaping on other threads.
+ *
+ * Since: REPLACEME
+ */
+void
+hb_face_warm (hb_face_t     *face,
+	      hb_executor_t *executor)
+{
+  if (unlikely (face->header.is_inert ()))
+    return;
+
+  face->table.warm ();
+#ifndef HB_NO_OT_LAYOUT
+  hb_ot_layout_warm_lookups (face, nullptr, nullptr,
+			     executor ? executor : hb_executor_get_empty ());
+#endif
+}
+
+/**
+ * hb_face_set_cmap_page_table:
+ * @face: A face object
+ * @enabled: Whether to use a page table
+ *
+ * Sets whether nominal-glyph lookups on @face in the Basic Multilingual
+ * Plane go through a dense page table, built from the `cmap` table on
+ * first use.  This makes each lookup two memory loads, instead of a
+ * search through the `cmap` subtable, at the cost of 512 bytes for every
+ * 256-character block the font covers; see
+ * hb_face_get_cmap_page_table_size().  It pays off for fonts with many
+ * `cmap` segments, like CJK fonts, that are used for a lot of text.
+ *
+ * The page table is only used for well-formed format 4 and format 12
+ * subtables.  This setting must be made before @face is first used.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_set_cmap_page_table (hb_face_t *face,
+			     hb_bool_t  enabled)
+{
+  if (hb_object_is_immutable (face))
+    return;
+
+  face->cmap_page_table = enabled;
+}
+
+/**
+ * hb_face_get_cmap_page_table:
+ * @face: A face object
+ *
+ * Fetches whether nominal-glyph lookups on @face use a page table.
+ * See hb_face_set_cmap_page_table().
+ *
+ * Return value: `true` if the page table was requested, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_face_get_cmap_page_table (const hb_face_t *face)
+{
+  return face->cmap_page_table;
+}
+
+/**
+ * hb_face_get_cmap_page_table_size:
+ * @face: A face object
+ *
+ * Fetches the memory used by the `cmap` page table of @face.
+ * See hb_face_set_cmap_page_table().
+ *
+ * Return value: The size of the page table in bytes, or zero if it
+ * was not requested, does not apply to the font, or was not built yet
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_get_cmap_page_table_size (hb_face_t *face)
+{
+  return face->table.cmap->get_page_table_size ();
+}
+
+/**
+ * hb_face_set_glyf_outline_cache_size:
+ * @face: A face object
+ * @max_bytes: The memory cap of the cache, in bytes; zero disables it
+ *
+ * Sets up a cache of decoded `glyf` simple glyphs on @face.  The cache
+ * keeps the points of glyphs used as components of composite glyphs,
+ * with variations applied, for each set of variation coordinates in use.
+ * Drawing or measuring other composites that share those components,
+ * like accented letters sharing their base letter and accents, then
+ * copies the points instead of decoding them again.
+ *
+ * Once the cache holds @max_bytes, entries that were not used recently
+ * are evicted.  The cache is off by default.  This setting must be
+ * made before @face is first used.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_set_glyf_outline_cache_size (hb_face_t    *face,
+				     unsigned int  max_bytes)
+{
+  if (hb_object_is_immutable (face))
+    return;
+
+  face->glyf_outline_cache_size = max_bytes;
+}
+
+/**
+ * hb_face_get_glyf_outline_cache_size:
+ * @face: A face object
+ *
+ * Fetches the memory cap of the `glyf` outline cache of @face.
+ * See hb_face_set_glyf_outline_cache_size().
+ *
+ * Return value: The memory cap in bytes, or zero if the cache is off
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_get_glyf_outline_cache_size (const hb_face_t *face)
+{
+  return face->glyf_outline_cache_size;
+}
+
+/**
+ * hb_face_get_glyf_outline_cache_stats:
+ * @face: A face object
+ * @hits: (out) (optional): Number of glyphs copied from the cache
+ * @misses: (out) (optional): Number of glyphs looked up in the cache
+ *   that had to be decoded
+ *
+ * Fetches statistics about the `glyf` outline cache of @face; see
+ * hb_face_set_glyf_outline_cache_size().  Both are zero if the cache is
+ * off.  The counters wrap around on overflow.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_get_glyf_outline_cache_stats (hb_face_t    *face,
+				      unsigned int *hits,  /* OUT */
+				      unsigned int *misses /* OUT */)
+{
+  face->table.glyf->get_outline_cache_stats (hits, misses);
+}
+
+/**
+ * hb_face_set_gvar_decoded_cache_size:
+ * @face: A face object
+ * @max_bytes: The memory cap of the cache, in bytes; zero disables it
+ *
+ * Sets up a cache of decoded `gvar` data on @face.  The variation data
+ * of each glyph is decoded once, the first time its outline is loaded,
+ * into native arrays of deltas.  Applying variations to the glyph at
+ * any other coordinates then only computes the scalars of its tuples
+ * and adds their deltas, instead of decoding them again.  This pays off
+ * for fonts drawn or measured at many variation coordinates, like when
+ * animating an axis.
+ *
+ * Glyphs are decoded until the cache holds @max_bytes, and are kept
+ * until @face is destroyed.  The cache also takes a pointer per glyph
+ * of @face; it is off if @max_bytes does not cover those.  The cache
+ * is off by default.  This setting must be made before @face is first
+ * used.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_face_set_gvar_decoded_cache_size (hb_face_t    *face,
+				     unsigned int  max_bytes)
+{
+  if (hb_object_is_immutable (face))
+    return;
+
+  face->gvar_decoded_cache_size = max_bytes;
+}
+
+/**
+ * hb_face_get_gvar_decoded_cache_size:
+ * @face: A face object
+ *
+ * Fetches the memory cap of the decoded `gvar` cache of @face.
+ * See hb_face_set_gvar_decoded_cache_size().
+ *
+ * Return value: The memory cap in bytes, or zero if the cache is off
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_face_get_gvar_decoded_cache_size (const hb_face_t *face)
+{
+  return face->gvar_decoded_cache_size;
+}
@@ -33,6 +33,7 @@
 
 #include "hb-common.h"
 #include "hb-blob.h"
+#include "hb-executor.h"
 #include "hb-map.h"
 #include "hb-set.h"
 
@@ -220,6 +221,40 @@ hb_face_collect_variation_unicodes (hb_face_t *face,
 				    hb_set_t  *out);
 
 
+HB_EXTERN void
+hb_face_warm (hb_face_t     *face,
+	      hb_executor_t *executor);
+
+HB_EXTERN void
+hb_face_set_cmap_page_table (hb_face_t *face,
+			     hb_bool_t  enabled);
+
+HB_EXTERN hb_bool_t
+hb_face_get_cmap_page_table (const hb_face_t *face);
+
+HB_EXTERN unsigned int
+hb_face_get_cmap_page_table_size (hb_face_t *face);
+
+HB_EXTERN void
+hb_face_set_glyf_outline_cache_size (hb_face_t    *face,
+				     unsigned int  max_bytes);
+
+HB_EXTERN unsigned int
+hb_face_get_glyf_outline_cache_size (const hb_face_t *face);
+
+HB_EXTERN void
+hb_face_get_glyf_outline_cache_stats (hb_face_t    *face,
+				      unsigned int *hits,  /* OUT */
+				      unsigned int *misses /* OUT */);
+
+HB_EXTERN void
+hb_face_set_gvar_decoded_cache_size (hb_face_t    *face,
+				     unsigned int  max_bytes);
+
+HB_EXTERN unsigned int
+hb_face_get_gvar_decoded_cache_size (const hb_face_t *face);
+
+
 /*
  * Builder face.
  */
@@ -51,6 +51,9 @@ struct hb_face_t
   unsigned int index;			/* Face index in a collection, zero-based. */
   mutable hb_atomic_t<unsigned> upem;	/* Units-per-EM. */
   mutable hb_atomic_t<unsigned> num_glyphs;/* Number of glyphs. */
+  bool cmap_page_table;			/* See hb_face_set_cmap_page_table(). */
+  unsigned glyf_outline_cache_size;	/* See hb_face_set_glyf_outline_cache_size(). */
+  unsigned gvar_decoded_cache_size;	/* See hb_face_set_gvar_decoded_cache_size(). */
 
   hb_reference_table_func_t  reference_table_func;
   void                      *user_data;
@@ -64,13 +67,10 @@ struct hb_face_t
   hb_ot_face_t table;			/* All the face's tables. */
 
   /* Cache */
-  struct plan_node_t
-  {
-    hb_shape_plan_t *shape_plan;
-    plan_node_t *next;
-  };
 #ifndef HB_NO_SHAPER
-  hb_atomic_t<plan_node_t *> shape_plans;
+  /* Created on first use; see hb_shape_plan_cache_t. */
+  hb_atomic_t<hb_shape_plan_cache_t *> shape_plans;
+  hb_atomic_t<unsigned> shape_plans_capacity;
 #endif
 
   hb_blob_t *reference_table (hb_tag_t tag) const
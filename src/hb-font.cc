@@ -534,6 +534,10 @@ hb_font_get_glyph_extents_default (hb_font_t          *font,
 				   hb_glyph_extents_t *extents,
 				   void               *user_data HB_UNUSED)
 {
+  if (font->has_glyph_extents_batch_func_set ())
+  {
+    return font->get_glyph_extents_batch (1, &glyph, 0, extents, 0, false);
+  }
   hb_bool_t ret = font->parent->get_glyph_extents (glyph, extents, false);
   if (ret) {
     font->parent_scale_position (&extents->x_bearing, &extents->y_bearing);
@@ -542,6 +546,44 @@ hb_font_get_glyph_extents_default (hb_font_t          *font,
   return ret;
 }
 
+#define hb_font_get_glyph_extents_batch_nil hb_font_get_glyph_extents_batch_default
+
+static hb_bool_t
+hb_font_get_glyph_extents_batch_default (hb_font_t            *font,
+					 void                 *font_data HB_UNUSED,
+					 unsigned int          count,
+					 const hb_codepoint_t *first_glyph,
+					 unsigned              glyph_stride,
+					 hb_glyph_extents_t   *first_extents,
+					 unsigned              extents_stride,
+					 void                 *user_data HB_UNUSED)
+{
+  if (font->has_glyph_extents_func_set ())
+  {
+    bool ret = true;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      ret &= (bool) font->get_glyph_extents (*first_glyph, first_extents, false);
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_extents = &StructAtOffsetUnaligned<hb_glyph_extents_t> (first_extents, extents_stride);
+    }
+    return ret;
+  }
+
+  hb_bool_t ret = font->parent->get_glyph_extents_batch (count,
+							 first_glyph, glyph_stride,
+							 first_extents, extents_stride,
+							 false);
+  /* Missing extents are zeroed, so scaling all of them is harmless. */
+  for (unsigned i = 0; i < count; i++)
+  {
+    font->parent_scale_position (&first_extents->x_bearing, &first_extents->y_bearing);
+    font->parent_scale_distance (&first_extents->width, &first_extents->height);
+    first_extents = &StructAtOffsetUnaligned<hb_glyph_extents_t> (first_extents, extents_stride);
+  }
+  return ret;
+}
+
 static hb_bool_t
 hb_font_get_glyph_contour_point_nil (hb_font_t      *font HB_UNUSED,
 				     void           *font_data HB_UNUSED,
@@ -1489,6 +1531,39 @@ hb_font_get_glyph_extents (hb_font_t          *font,
   return font->get_glyph_extents (glyph, extents);
 }
 
+/**
+ * hb_font_get_glyph_extents_batch:
+ * @font: #hb_font_t to work upon
+ * @count: The number of glyph IDs in the sequence queried
+ * @first_glyph: The first glyph ID to query
+ * @glyph_stride: The stride between successive glyph IDs
+ * @first_extents: (out): The first #hb_glyph_extents_t retrieved
+ * @extents_stride: The stride between successive extents
+ *
+ * Fetches the #hb_glyph_extents_t data for a sequence of glyph IDs
+ * in the specified font.  Extents of glyphs that have none are
+ * zeroed.
+ *
+ * This is equivalent to calling hb_font_get_glyph_extents() for
+ * each glyph in turn.
+ *
+ * Return value: `true` if data was found for all glyphs, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_font_get_glyph_extents_batch (hb_font_t            *font,
+				 unsigned int          count,
+				 const hb_codepoint_t *first_glyph,
+				 unsigned int          glyph_stride,
+				 hb_glyph_extents_t   *first_extents,
+				 unsigned int          extents_stride)
+{
+  return font->get_glyph_extents_batch (count,
+					first_glyph, glyph_stride,
+					first_extents, extents_stride);
+}
+
 /**
  * hb_font_get_glyph_contour_point:
  * @font: #hb_font_t to work upon
@@ -1698,6 +1773,85 @@ hb_font_draw_glyph (hb_font_t *font,
   (void) hb_font_draw_glyph_or_fail (font, glyph, dfuncs, draw_data);
 }
 
+/**
+ * hb_font_draw_glyphs_packed:
+ * @font: #hb_font_t to work upon
+ * @glyph_count: The number of glyph IDs in the sequence
+ * @first_glyph: The first glyph ID to draw
+ * @glyph_stride: The stride between successive glyph IDs
+ * @verb_count: (inout): Input = the size of @verbs; Output = the number of verbs written
+ * @verbs: (out) (array length=verb_count): The #hb_draw_verb_t drawing commands
+ * @point_count: (inout): Input = the number of points @points can hold;
+ *   Output = the number of points written
+ * @points: (out): The points of the drawing commands, as pairs of X and Y
+ *   components; must hold twice @point_count floats
+ * @glyph_verb_offsets: (out) (nullable): If not `NULL`, receives the offset
+ *   into @verbs at which each glyph starts, followed by the total number
+ *   of verbs; must hold @glyph_count + 1 entries
+ *
+ * Draws the outlines of a sequence of glyphs in the specified @font into
+ * a packed, caller-owned buffer of drawing commands.
+ *
+ * The commands are the same as those hb_font_draw_glyph() would make
+ * to a #hb_draw_funcs_t, one #hb_draw_verb_t per callback.  Each verb
+ * consumes a fixed number of points; see #hb_draw_verb_t.  Glyphs with
+ * no outline produce no commands.
+ *
+ * This gives the caller the outlines of all glyphs in one contiguous
+ * buffer, without having to implement a #hb_draw_funcs_t.
+ *
+ * Glyphs are drawn in order until one does not fit in the remaining
+ * space.  The caller can then grow the buffers, or consume their
+ * contents, and call again starting with the first glyph not drawn.
+ *
+ * Return value: The number of glyphs drawn
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_font_draw_glyphs_packed (hb_font_t *font,
+			    unsigned int glyph_count,
+			    const hb_codepoint_t *first_glyph,
+			    unsigned int glyph_stride,
+			    unsigned int *verb_count, /* IN/OUT */
+			    uint8_t *verbs, /* OUT */
+			    unsigned int *point_count, /* IN/OUT */
+			    float *points, /* OUT */
+			    unsigned int *glyph_verb_offsets /* OUT, may be NULL */)
+{
+  hb_draw_packed_t packed {verbs, *verb_count, points, *point_count};
+  unsigned int i = 0;
+
+#ifndef HB_NO_DRAW
+  hb_draw_funcs_t *dfuncs = hb_draw_packed_get_funcs ();
+  if (unlikely (dfuncs->header.is_inert ()))
+    glyph_count = 0;
+
+  for (; i < glyph_count; i++)
+  {
+    unsigned int verb_start = packed.verb_count;
+    unsigned int point_start = packed.point_count;
+    if (glyph_verb_offsets)
+      glyph_verb_offsets[i] = verb_start;
+
+    (void) font->draw_glyph_or_fail (*first_glyph, dfuncs, &packed);
+    if (unlikely (packed.in_error ()))
+    {
+      packed.truncate (verb_start, point_start);
+      break;
+    }
+
+    first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+  }
+#endif
+
+  if (glyph_verb_offsets)
+    glyph_verb_offsets[i] = packed.verb_count;
+  *verb_count = packed.verb_count;
+  *point_count = packed.point_count;
+  return i;
+}
+
 /**
  * hb_font_paint_glyph:
  * @font: #hb_font_t to work upon
@@ -2184,6 +2338,7 @@ hb_font_create_sub_font (hb_font_t *parent)
   font->y_embolden = parent->y_embolden;
   font->embolden_in_place = parent->embolden_in_place;
   font->slant = parent->slant;
+  font->cache_policy = parent->cache_policy;
   font->x_ppem = parent->x_ppem;
   font->y_ppem = parent->y_ppem;
   font->ptem = parent->ptem;
@@ -2260,6 +2415,11 @@ hb_font_destroy (hb_font_t *font)
 
   font->data.fini ();
 
+#ifndef HB_NO_SHAPER
+  for (auto &shape_plan : font->shape_plans)
+    hb_shape_plan_destroy (shape_plan.get_relaxed ());
+#endif
+
   if (font->destroy)
     font->destroy (font->user_data);
 
@@ -2355,6 +2515,72 @@ hb_font_is_immutable (hb_font_t *font)
   return hb_object_is_immutable (font);
 }
 
+/**
+ * hb_font_freeze:
+ * @font: #hb_font_t to work upon
+ *
+ * Makes @font immutable, like hb_font_make_immutable(), and prepares it
+ * for being shared by many shaping threads at once.  The tables of the
+ * face, the accelerators of all its lookups, and the shaper data of
+ * @font are built right away, instead of lazily on first use.
+ *
+ * Afterwards, the built-in OpenType font functions share their advance,
+ * origin and extents caches between all threads in place, instead of
+ * handing them to one thread at a time.  The caches of decoded variation
+ * data used to compute those, and to draw glyphs, are not thread-safe, so
+ * are not used at all; for a variable font, cache misses and drawing can
+ * be slower than on a font that isn't frozen.  @font also holds on to
+ * the shaping plans for the first few combinations of segment
+ * properties, features and variations it is shaped with, and uses them
+ * without locking the shape-plan cache of the face or reference counting
+ * them; other combinations go through that cache as usual.  Shaping then needs no atomic read-modify-write
+ * operations once the caches are warm.  In exchange,
+ * hb_font_get_advance_cache_stats() and hb_shape_plan_cache_get_stats()
+ * stop counting the lookups made through @font.
+ *
+ * Call this before sharing @font with other threads.  The parent of
+ * @font, if any, is frozen too.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_font_freeze (hb_font_t *font)
+{
+  if (unlikely (font->header.is_inert ()) || font->frozen)
+    return;
+
+  if (font->parent)
+    hb_font_freeze (font->parent);
+
+  hb_font_make_immutable (font);
+
+  hb_face_warm (font->face, nullptr);
+#define HB_SHAPER_IMPLEMENT(shaper) (void) !font->data.shaper;
+#include "hb-shaper-list.hh"
+#undef HB_SHAPER_IMPLEMENT
+#ifndef HB_NO_OT_FONT
+  _hb_ot_font_freeze (font);
+#endif
+
+  font->frozen = true;
+}
+
+/**
+ * hb_font_is_frozen:
+ * @font: #hb_font_t to work upon
+ *
+ * Tests whether a font object was frozen with hb_font_freeze().
+ *
+ * Return value: `true` if @font is frozen, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_font_is_frozen (hb_font_t *font)
+{
+  return font->frozen;
+}
+
 /**
  * hb_font_get_serial:
  * @font: #hb_font_t to work upon
@@ -3004,6 +3230,82 @@ hb_font_get_synthetic_slant (hb_font_t *font)
   return font->slant;
 }
 
+/**
+ * hb_font_set_cache_policy:
+ * @font: #hb_font_t to work upon
+ * @policy: the cache policy to use
+ *
+ * Sets how large the per-glyph metrics caches kept for @font should
+ * be.  The default suits most scripts; text that uses thousands of
+ * distinct glyphs, like Chinese, Japanese or Korean, gets more cache
+ * hits from #HB_FONT_CACHE_POLICY_LARGE, at the cost of more memory.
+ *
+ * Changing the policy empties the font's caches, and resets the
+ * counters returned by hb_font_get_advance_cache_stats().
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_font_set_cache_policy (hb_font_t *font,
+			  hb_font_cache_policy_t policy)
+{
+  if (hb_object_is_immutable (font))
+    return;
+
+  if (font->cache_policy == policy)
+    return;
+
+  font->cache_policy = policy;
+  font->advance_cache_lookups = 0;
+  font->advance_cache_misses = 0;
+
+  font->changed ();
+  font->serial_coords = font->serial;
+}
+
+/**
+ * hb_font_get_cache_policy:
+ * @font: #hb_font_t to work upon
+ *
+ * Fetches the cache policy of a font.
+ *
+ * Return value: The cache policy.  By default is #HB_FONT_CACHE_POLICY_DEFAULT.
+ *
+ * Since: REPLACEME
+ **/
+hb_font_cache_policy_t
+hb_font_get_cache_policy (hb_font_t *font)
+{
+  return font->cache_policy;
+}
+
+/**
+ * hb_font_get_advance_cache_stats:
+ * @font: #hb_font_t to work upon
+ * @lookups: (out) (optional): Output number of glyph advances looked up in the cache
+ * @misses: (out) (optional): Output number of those not found in the cache
+ *
+ * Fetches how well the glyph-advance cache of @font is doing, to help
+ * pick a cache policy with hb_font_set_cache_policy().  The counts
+ * accumulate from when the font was created or its cache policy was
+ * last changed, and are approximate if the font is used from several
+ * threads at once.
+ *
+ * Only font functions that cache advances count them.  The built-in
+ * OpenType functions only need to for variable fonts, so the counts
+ * stay zero for fonts at their default instance.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_font_get_advance_cache_stats (hb_font_t *font,
+				 unsigned int *lookups,
+				 unsigned int *misses)
+{
+  if (lookups) *lookups = font->advance_cache_lookups;
+  if (misses) *misses = font->advance_cache_misses;
+}
+
 #ifndef HB_NO_VAR
 /*
  * Variations
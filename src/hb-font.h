@@ -475,6 +475,34 @@ typedef hb_bool_t (*hb_font_get_glyph_extents_func_t) (hb_font_t *font, void *fo
 						       hb_glyph_extents_t *extents,
 						       void *user_data);
 
+/**
+ * hb_font_get_glyph_extents_batch_func_t:
+ * @font: #hb_font_t to work upon
+ * @font_data: @font user data pointer
+ * @count: number of glyphs to query
+ * @first_glyph: The first glyph ID to query
+ * @glyph_stride: The stride between successive glyph IDs
+ * @first_extents: (out): The first #hb_glyph_extents_t retrieved
+ * @extents_stride: The stride between successive extents
+ * @user_data: User data pointer passed by the caller
+ *
+ * A virtual method for the #hb_font_funcs_t of an #hb_font_t object.
+ *
+ * This method should retrieve the extents for each requested glyph.
+ * Extents of glyphs that have none must be zeroed.
+ *
+ * Return value: `true` if data found for all glyphs, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+typedef hb_bool_t (*hb_font_get_glyph_extents_batch_func_t) (hb_font_t *font, void *font_data,
+							     unsigned int count,
+							     const hb_codepoint_t *first_glyph,
+							     unsigned glyph_stride,
+							     hb_glyph_extents_t *first_extents,
+							     unsigned extents_stride,
+							     void *user_data);
+
 /**
  * hb_font_get_glyph_contour_point_func_t:
  * @font: #hb_font_t to work upon
@@ -830,6 +858,22 @@ hb_font_funcs_set_glyph_extents_func (hb_font_funcs_t *ffuncs,
 				      hb_font_get_glyph_extents_func_t func,
 				      void *user_data, hb_destroy_func_t destroy);
 
+/**
+ * hb_font_funcs_set_glyph_extents_batch_func:
+ * @ffuncs: A font-function structure
+ * @func: (closure user_data) (destroy destroy) (scope notified): The callback function to assign
+ * @user_data: Data to pass to @func
+ * @destroy: (nullable): The function to call when @user_data is not needed anymore
+ *
+ * Sets the implementation function for #hb_font_get_glyph_extents_batch_func_t.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_font_funcs_set_glyph_extents_batch_func (hb_font_funcs_t *ffuncs,
+					    hb_font_get_glyph_extents_batch_func_t func,
+					    void *user_data, hb_destroy_func_t destroy);
+
 /**
  * hb_font_funcs_set_glyph_contour_point_func:
  * @ffuncs: A font-function structure
@@ -996,6 +1040,14 @@ hb_font_get_glyph_extents (hb_font_t *font,
 			   hb_codepoint_t glyph,
 			   hb_glyph_extents_t *extents);
 
+HB_EXTERN hb_bool_t
+hb_font_get_glyph_extents_batch (hb_font_t *font,
+				 unsigned int count,
+				 const hb_codepoint_t *first_glyph,
+				 unsigned int glyph_stride,
+				 hb_glyph_extents_t *first_extents,
+				 unsigned int extents_stride);
+
 HB_EXTERN hb_bool_t
 hb_font_get_glyph_contour_point (hb_font_t *font,
 				 hb_codepoint_t glyph, unsigned int point_index,
@@ -1099,6 +1151,17 @@ hb_font_draw_glyph (hb_font_t *font,
 		    hb_codepoint_t glyph,
 		    hb_draw_funcs_t *dfuncs, void *draw_data);
 
+HB_EXTERN unsigned int
+hb_font_draw_glyphs_packed (hb_font_t *font,
+			    unsigned int glyph_count,
+			    const hb_codepoint_t *first_glyph,
+			    unsigned int glyph_stride,
+			    unsigned int *verb_count, /* IN/OUT */
+			    uint8_t *verbs, /* OUT */
+			    unsigned int *point_count, /* IN/OUT */
+			    float *points, /* OUT */
+			    unsigned int *glyph_verb_offsets /* OUT, may be NULL */);
+
 /* Paints color glyph; if failed, draws outline glyph. */
 HB_EXTERN void
 hb_font_paint_glyph (hb_font_t *font,
@@ -1146,6 +1209,12 @@ hb_font_make_immutable (hb_font_t *font);
 HB_EXTERN hb_bool_t
 hb_font_is_immutable (hb_font_t *font);
 
+HB_EXTERN void
+hb_font_freeze (hb_font_t *font);
+
+HB_EXTERN hb_bool_t
+hb_font_is_frozen (hb_font_t *font);
+
 HB_EXTERN unsigned int
 hb_font_get_serial (hb_font_t *font);
 
@@ -1238,6 +1307,36 @@ hb_font_set_synthetic_slant (hb_font_t *font, float slant);
 HB_EXTERN float
 hb_font_get_synthetic_slant (hb_font_t *font);
 
+/**
+ * hb_font_cache_policy_t:
+ * @HB_FONT_CACHE_POLICY_DEFAULT: Small per-glyph caches, suited to
+ * text that uses a few hundred distinct glyphs at a time, as with
+ * most alphabetic scripts.
+ * @HB_FONT_CACHE_POLICY_LARGE: Larger per-glyph caches, for text
+ * that uses thousands of distinct glyphs, as with Chinese, Japanese
+ * or Korean.  These use more memory per font.
+ *
+ * How large the per-glyph metrics caches kept for a font should be.
+ *
+ * Since: REPLACEME
+ **/
+typedef enum {
+  HB_FONT_CACHE_POLICY_DEFAULT,
+  HB_FONT_CACHE_POLICY_LARGE
+} hb_font_cache_policy_t;
+
+HB_EXTERN void
+hb_font_set_cache_policy (hb_font_t *font,
+			  hb_font_cache_policy_t policy);
+
+HB_EXTERN hb_font_cache_policy_t
+hb_font_get_cache_policy (hb_font_t *font);
+
+HB_EXTERN void
+hb_font_get_advance_cache_stats (hb_font_t *font,
+				 unsigned int *lookups,
+				 unsigned int *misses);
+
 HB_EXTERN void
 hb_font_set_variations (hb_font_t *font,
 			const hb_variation_t *variations,
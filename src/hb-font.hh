@@ -65,6 +65,7 @@
   HB_FONT_FUNC_IMPLEMENT (get_,glyph_from_name) \
   HB_FONT_FUNC_IMPLEMENT (,draw_glyph_or_fail) \
   HB_FONT_FUNC_IMPLEMENT (,paint_glyph_or_fail) \
+  HB_FONT_FUNC_IMPLEMENT (get_,glyph_extents_batch) \
   /* ^--- Add new callbacks here */
 
 struct hb_font_funcs_t
@@ -154,6 +155,37 @@ struct hb_font_t
 
   hb_shaper_object_dataset_t<hb_font_t> data; /* Various shaper data. */
 
+  hb_font_cache_policy_t cache_policy;
+  /* Kept by the font-funcs that cache advances, for tuning cache_policy. */
+  hb_atomic_t<unsigned> advance_cache_lookups;
+  hb_atomic_t<unsigned> advance_cache_misses;
+  /* See hb_font_freeze().  Font-funcs may then share their caches in
+   * place between threads, and skip anything that writes to shared
+   * state on every call, like the counters above. */
+  bool frozen;
+#ifndef HB_NO_SHAPER
+  /* The shape plans a frozen font holds on to; see hb_shape_plan_get_cached(). */
+  hb_atomic_t<hb_shape_plan_t *> shape_plans[HB_FONT_FROZEN_SHAPE_PLANS];
+#endif
+
+
+  /* The number of index bits for per-glyph caches under cache_policy. */
+  unsigned glyph_cache_bits () const
+  {
+    return cache_policy == HB_FONT_CACHE_POLICY_LARGE ?
+	   HB_FONT_GLYPH_CACHE_BITS_LARGE : HB_FONT_GLYPH_CACHE_BITS_DEFAULT;
+  }
+
+  /* Not atomic increments: these are statistics, and losing a few
+   * counts to concurrent use is cheaper than contending on them. */
+  void count_advance_cache_lookups (unsigned lookups, unsigned misses)
+  {
+    if (frozen)
+      return;
+    advance_cache_lookups.set_relaxed (advance_cache_lookups.get_relaxed () + lookups);
+    if (misses)
+      advance_cache_misses.set_relaxed (advance_cache_misses.get_relaxed () + misses);
+  }
 
   /* Convert from font-space to user-space */
   int64_t dir_mult (hb_direction_t direction)
@@ -646,6 +678,38 @@ struct hb_font_t
     return ret;
   }
 
+  hb_bool_t get_glyph_extents_batch (unsigned int count,
+				     const hb_codepoint_t *first_glyph,
+				     unsigned int glyph_stride,
+				     hb_glyph_extents_t *first_extents,
+				     unsigned int extents_stride,
+				     bool synthetic = true)
+  {
+    /* Same order of preference as get_glyph_extents(); if the batch
+     * comes back incomplete, redo it glyph by glyph so the missing
+     * ones get a chance at paint() and draw(). */
+    if (!synthetic || !is_synthetic)
+    {
+      if (klass->get.f.glyph_extents_batch (this, user_data,
+					    count,
+					    first_glyph, glyph_stride,
+					    first_extents, extents_stride,
+					    !klass->user_data ? nullptr : klass->user_data->glyph_extents_batch))
+	return true;
+      if (!synthetic)
+	return false;
+    }
+
+    bool ret = true;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      ret &= (bool) get_glyph_extents (*first_glyph, first_extents);
+      first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      first_extents = &StructAtOffsetUnaligned<hb_glyph_extents_t> (first_extents, extents_stride);
+    }
+    return ret;
+  }
+
   hb_bool_t get_glyph_contour_point (hb_codepoint_t glyph, unsigned int point_index,
 				     hb_position_t *x, hb_position_t *y,
 				     bool synthetic = true)
@@ -1180,5 +1244,12 @@ struct hb_font_t
 };
 DECLARE_NULL_INSTANCE (hb_font_t);
 
+#ifndef HB_NO_OT_FONT
+HB_INTERNAL void
+_hb_ot_font_warm (hb_font_t *font);
+HB_INTERNAL void
+_hb_ot_font_freeze (hb_font_t *font);
+#endif
+
 
 #endif /* HB_FONT_HH */
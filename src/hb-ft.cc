@@ -86,7 +86,111 @@
  */
 
 
-using hb_ft_advance_cache_t = hb_cache_t<16, 24, 8, false>;
+/* The caches below are thread-safe, and shared in place by all threads
+ * using a font, such that FreeType, and the lock guarding it, is only
+ * needed on cache misses.  The caches are only emptied or replaced when
+ * the font changes, which must not happen while it is in use. */
+
+using hb_ft_nominal_cache_t = hb_cache_t<21, 19>;
+static_assert (sizeof (hb_ft_nominal_cache_t) == 1024, "");
+
+using hb_ft_advance_cache_t = hb_sized_cache_t<16, 24,
+						HB_FONT_GLYPH_CACHE_BITS_DEFAULT,
+						HB_FONT_GLYPH_CACHE_BITS_LARGE>;
+
+/* Extents don't fit in an hb_cache_t item, so each field gets a cache
+ * of its own.  A glyph's fields don't change until the caches are
+ * cleared, so a lookup can't see a mix of fields from different glyphs
+ * or font states, even if threads race storing them. */
+struct hb_ft_extents_cache_t
+{
+  using cache_t = hb_cache_t<16, 24>;
+  static constexpr int BIAS = 1 << 23;
+
+  void clear ()
+  {
+    x_bearing.clear ();
+    y_bearing.clear ();
+    width.clear ();
+    height.clear ();
+  }
+
+  bool get (hb_codepoint_t glyph, hb_glyph_extents_t *extents) const
+  {
+    unsigned xb, yb, w, h;
+    if (!x_bearing.get (glyph, &xb) || !y_bearing.get (glyph, &yb) ||
+	!width.get (glyph, &w) || !height.get (glyph, &h))
+      return false;
+    extents->x_bearing = (int) xb - BIAS;
+    extents->y_bearing = (int) yb - BIAS;
+    extents->width = (int) w - BIAS;
+    extents->height = (int) h - BIAS;
+    return true;
+  }
+
+  /* Fields out of range aren't stored, leaving the glyph uncached. */
+  void set (hb_codepoint_t glyph, const hb_glyph_extents_t &extents)
+  {
+    x_bearing.set (glyph, (unsigned) (extents.x_bearing + BIAS));
+    y_bearing.set (glyph, (unsigned) (extents.y_bearing + BIAS));
+    width.set (glyph, (unsigned) (extents.width + BIAS));
+    height.set (glyph, (unsigned) (extents.height + BIAS));
+  }
+
+  private:
+  cache_t x_bearing, y_bearing, width, height;
+};
+
+/* Points of glyphs below 65536, with indices below 256, keyed by both;
+ * see hb_ft_extents_cache_t for why separate coordinates are fine. */
+struct hb_ft_contour_point_cache_t
+{
+  using cache_t = hb_cache_t<24, 18, 10>;
+  static constexpr int BIAS = 1 << 17;
+
+  void clear ()
+  {
+    x.clear ();
+    y.clear ();
+  }
+
+  bool get (hb_codepoint_t glyph, unsigned point_index,
+	    hb_position_t *px, hb_position_t *py) const
+  {
+    if (unlikely ((glyph >> 16) || (point_index >> 8)))
+      return false;
+    unsigned key = (glyph << 8) | point_index;
+    unsigned vx, vy;
+    if (!x.get (key, &vx) || !y.get (key, &vy))
+      return false;
+    *px = (int) vx - BIAS;
+    *py = (int) vy - BIAS;
+    return true;
+  }
+
+  void set (hb_codepoint_t glyph, unsigned point_index,
+	    hb_position_t px, hb_position_t py)
+  {
+    if (unlikely ((glyph >> 16) || (point_index >> 8)))
+      return;
+    unsigned key = (glyph << 8) | point_index;
+    x.set (key, (unsigned) (px + BIAS));
+    y.set (key, (unsigned) (py + BIAS));
+  }
+
+  private:
+  cache_t x, y;
+};
+
+template <typename T>
+static T *
+_hb_ft_cache_create ()
+{
+  T *cache = (T *) hb_malloc (sizeof (T));
+  if (likely (cache))
+    new (cache) T ();
+  return cache;
+}
 
 struct hb_ft_font_t
 {
@@ -98,7 +202,50 @@ struct hb_ft_font_t
   mutable hb_mutex_t lock; /* Protects members below. */
   FT_Face ft_face;
   mutable hb_atomic_t<unsigned> cached_serial;
-  mutable hb_ft_advance_cache_t advance_cache;
+
+  /* Caches; replaced only with lock held, read without it.  Since the
+   * lock is held, the cmpexch()es that publish them always succeed. */
+  mutable hb_atomic_t<hb_ft_nominal_cache_t *> nominal_cache;
+  mutable hb_atomic_t<hb_ft_advance_cache_t *> advance_cache; /* Sized by the font's cache policy. */
+  mutable hb_atomic_t<hb_ft_extents_cache_t *> extents_cache;
+  mutable hb_atomic_t<hb_ft_contour_point_cache_t *> contour_point_cache; /* Created on first use. */
+
+  /* Empties the caches that depend on the font's size, variations and
+   * load flags, creating them as needed, and resizing the advance cache
+   * if the cache policy of the font changed.  Must be called with lock
+   * held. */
+  void reset_caches (hb_font_t *font) const
+  {
+    unsigned cache_bits = font->glyph_cache_bits ();
+    hb_ft_advance_cache_t *advances = advance_cache.get_relaxed ();
+    if (advances && advances->get_cache_bits () == cache_bits)
+      advances->clear ();
+    else
+    {
+      advance_cache.cmpexch (advances, hb_ft_advance_cache_t::create (cache_bits));
+      hb_ft_advance_cache_t::destroy (advances);
+    }
+
+    if (auto *extents = extents_cache.get_relaxed ())
+      extents->clear ();
+    else
+      extents_cache.cmpexch (nullptr, _hb_ft_cache_create<hb_ft_extents_cache_t> ());
+
+    if (auto *points = contour_point_cache.get_relaxed ())
+      points->clear ();
+  }
+
+  /* Must be called with lock held. */
+  hb_ft_contour_point_cache_t *get_contour_point_cache () const
+  {
+    auto *points = contour_point_cache.get_relaxed ();
+    if (!points)
+    {
+      points = _hb_ft_cache_create<hb_ft_contour_point_cache_t> ();
+      contour_point_cache.cmpexch (nullptr, points);
+    }
+    return points;
+  }
 };
 
 static hb_ft_font_t *
@@ -115,7 +262,8 @@ _hb_ft_font_create (FT_Face ft_face, bool symbol, bool unref)
   ft_font->load_flags = FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING;
 
   ft_font->cached_serial = UINT_MAX;
-  new (&ft_font->advance_cache) hb_ft_advance_cache_t;
+
+  ft_font->nominal_cache.set_relaxed (_hb_ft_cache_create<hb_ft_nominal_cache_t> ());
 
   return ft_font;
 }
@@ -134,6 +282,11 @@ _hb_ft_font_destroy (void *data)
   if (ft_font->unref)
     _hb_ft_face_destroy (ft_font->ft_face);
 
+  hb_free (ft_font->nominal_cache.get_relaxed ());
+  hb_ft_advance_cache_t::destroy (ft_font->advance_cache.get_relaxed ());
+  hb_free (ft_font->extents_cache.get_relaxed ());
+  hb_free (ft_font->contour_point_cache.get_relaxed ());
+
   ft_font->lock.fini ();
 
   hb_free (ft_font);
@@ -218,11 +371,14 @@ static inline bool
 _hb_ft_hb_font_check_changed (hb_font_t *font,
 			      const hb_ft_font_t *ft_font)
 {
-  if (font->serial != ft_font->cached_serial)
+  if (font->serial != ft_font->cached_serial.get_acquire ())
   {
     hb_lock_t lock (ft_font->lock);
+    /* Another thread may have caught up while we waited. */
+    if (font->serial == ft_font->cached_serial.get_relaxed ())
+      return false;
     _hb_ft_hb_font_changed (font, ft_font->ft_face);
-    ft_font->advance_cache.clear ();
+    ft_font->reset_caches (font);
     ft_font->cached_serial.set_release (font->serial.get_acquire ());
     return true;
   }
@@ -257,6 +413,8 @@ hb_ft_font_set_load_flags (hb_font_t *font, int load_flags)
   hb_ft_font_t *ft_font = (hb_ft_font_t *) font->user_data;
 
   ft_font->load_flags = load_flags;
+  /* Cached metrics depend on the load flags; refresh on next use. */
+  ft_font->cached_serial = UINT_MAX;
 }
 
 /**
@@ -392,6 +550,14 @@ hb_ft_get_nominal_glyph (hb_font_t *font,
 			 void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
+  hb_ft_nominal_cache_t *nominal_cache = ft_font->nominal_cache.get_acquire ();
+  unsigned cv;
+  if (likely (nominal_cache) && nominal_cache->get (unicode, &cv))
+  {
+    *glyph = cv;
+    return true;
+  }
+
   hb_lock_t lock (ft_font->lock);
   unsigned int g = FT_Get_Char_Index (ft_font->ft_face, unicode);
 
@@ -427,6 +593,8 @@ hb_ft_get_nominal_glyph (hb_font_t *font,
       return false;
   }
 
+  if (likely (nominal_cache))
+    nominal_cache->set (unicode, g);
   *glyph = g;
   return true;
 }
@@ -442,15 +610,32 @@ hb_ft_get_nominal_glyphs (hb_font_t *font HB_UNUSED,
 			  void *user_data HB_UNUSED)
 {
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  hb_lock_t lock (ft_font->lock);
+  hb_ft_nominal_cache_t *nominal_cache = ft_font->nominal_cache.get_acquire ();
+  bool locked = false;
   unsigned int done;
-  for (done = 0;
-       done < count && (*first_glyph = FT_Get_Char_Index (ft_font->ft_face, *first_unicode));
-       done++)
+  for (done = 0; done < count; done++)
   {
+    hb_codepoint_t unicode = *first_unicode;
+    unsigned cv;
+    if (likely (nominal_cache) && nominal_cache->get (unicode, &cv))
+      *first_glyph = cv;
+    else
+    {
+      if (!locked)
+      {
+	ft_font->lock.lock ();
+	locked = true;
+      }
+      if (!(*first_glyph = FT_Get_Char_Index (ft_font->ft_face, unicode)))
+	break;
+      if (likely (nominal_cache))
+	nominal_cache->set (unicode, *first_glyph);
+    }
     first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
     first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
   }
+  if (locked)
+    ft_font->lock.unlock ();
   /* We don't need to do ft_font->symbol dance here, since HB calls the singular
    * nominal_glyph() for what we don't handle here. */
   return done;
@@ -488,46 +673,60 @@ hb_ft_get_glyph_h_advances (hb_font_t* font, void* font_data,
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
   _hb_ft_hb_font_check_changed (font, ft_font);
 
-  hb_lock_t lock (ft_font->lock);
   FT_Face ft_face = ft_font->ft_face;
   int load_flags = ft_font->load_flags;
-  float x_mult;
-#ifdef HAVE_FT_GET_TRANSFORM
-  if (ft_font->transform)
-  {
-    FT_Matrix matrix;
-    FT_Get_Transform (ft_face, &matrix, nullptr);
-    x_mult = sqrtf ((float)matrix.xx * matrix.xx + (float)matrix.xy * matrix.xy) / 65536.f;
-    x_mult *= font->x_scale < 0 ? -1 : +1;
-  }
-  else
-#endif
-  {
-    x_mult = font->x_scale < 0 ? -1 : +1;
-  }
+  float x_mult = 1.f;
+  bool locked = false;
 
+  hb_ft_advance_cache_t *advance_cache = ft_font->advance_cache.get_acquire ();
+  unsigned misses = 0;
   for (unsigned int i = 0; i < count; i++)
   {
     FT_Fixed v = 0;
     hb_codepoint_t glyph = *first_glyph;
 
     unsigned int cv;
-    if (ft_font->advance_cache.get (glyph, &cv))
+    if (likely (advance_cache) && advance_cache->get (glyph, &cv))
       v = cv;
     else
     {
+      if (!locked)
+      {
+	/* Only take the lock once we need FreeType. */
+	ft_font->lock.lock ();
+	locked = true;
+#ifdef HAVE_FT_GET_TRANSFORM
+	if (ft_font->transform)
+	{
+	  FT_Matrix matrix;
+	  FT_Get_Transform (ft_face, &matrix, nullptr);
+	  x_mult = sqrtf ((float)matrix.xx * matrix.xx + (float)matrix.xy * matrix.xy) / 65536.f;
+	  x_mult *= font->x_scale < 0 ? -1 : +1;
+	}
+	else
+#endif
+	{
+	  x_mult = font->x_scale < 0 ? -1 : +1;
+	}
+      }
+
       FT_Get_Advance (ft_face, glyph, load_flags, &v);
       /* Work around bug that FreeType seems to return negative advance
        * for variable-set fonts if x_scale is negative! */
       v = abs (v);
       v = (int) (v * x_mult + (1<<9)) >> 10;
-      ft_font->advance_cache.set (glyph, v);
+      misses++;
+      if (likely (advance_cache))
+	advance_cache->set (glyph, v);
     }
 
     *first_advance = v;
     first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
     first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
   }
+  if (locked)
+    ft_font->lock.unlock ();
+  font->count_advance_cache_lookups (count, misses);
 }
 
 #ifndef HB_NO_VERTICAL
@@ -672,40 +871,37 @@ hb_ft_is_colr_glyph (hb_font_t *font,
   return false;
 }
 
-static hb_bool_t
-hb_ft_get_glyph_extents (hb_font_t *font,
-			 void *font_data,
-			 hb_codepoint_t glyph,
-			 hb_glyph_extents_t *extents,
-			 void *user_data HB_UNUSED)
+static void
+_hb_ft_get_extents_mults (hb_font_t *font,
+			  const hb_ft_font_t *ft_font,
+			  float *x_mult, float *y_mult)
 {
-  // FreeType doesn't return COLR glyph extents.
-  if (hb_ft_is_colr_glyph (font, font_data, glyph))
-    return false;
-
-  const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
-  _hb_ft_hb_font_check_changed (font, ft_font);
-
-  hb_lock_t lock (ft_font->lock);
-  FT_Face ft_face = ft_font->ft_face;
-  float x_mult, y_mult;
-
 #ifdef HAVE_FT_GET_TRANSFORM
   if (ft_font->transform)
   {
     FT_Matrix matrix;
-    FT_Get_Transform (ft_face, &matrix, nullptr);
-    x_mult = sqrtf ((float)matrix.xx * matrix.xx + (float)matrix.xy * matrix.xy) / 65536.f;
-    x_mult *= font->x_scale < 0 ? -1 : +1;
-    y_mult = sqrtf ((float)matrix.yx * matrix.yx + (float)matrix.yy * matrix.yy) / 65536.f;
-    y_mult *= font->y_scale < 0 ? -1 : +1;
+    FT_Get_Transform (ft_font->ft_face, &matrix, nullptr);
+    *x_mult = sqrtf ((float)matrix.xx * matrix.xx + (float)matrix.xy * matrix.xy) / 65536.f;
+    *x_mult *= font->x_scale < 0 ? -1 : +1;
+    *y_mult = sqrtf ((float)matrix.yx * matrix.yx + (float)matrix.yy * matrix.yy) / 65536.f;
+    *y_mult *= font->y_scale < 0 ? -1 : +1;
   }
   else
 #endif
   {
-    x_mult = font->x_scale < 0 ? -1 : +1;
-    y_mult = font->y_scale < 0 ? -1 : +1;
+    *x_mult = font->x_scale < 0 ? -1 : +1;
+    *y_mult = font->y_scale < 0 ? -1 : +1;
   }
+}
+
+/* Must be called with ft_font->lock held. */
+static bool
+_hb_ft_load_glyph_extents (const hb_ft_font_t *ft_font,
+			   hb_codepoint_t glyph,
+			   float x_mult, float y_mult,
+			   hb_glyph_extents_t *extents)
+{
+  FT_Face ft_face = ft_font->ft_face;
 
   if (unlikely (FT_Load_Glyph (ft_face, glyph, ft_font->load_flags)))
     return false;
@@ -725,6 +921,94 @@ hb_ft_get_glyph_extents (hb_font_t *font,
   return true;
 }
 
+static hb_bool_t
+hb_ft_get_glyph_extents (hb_font_t *font,
+			 void *font_data,
+			 hb_codepoint_t glyph,
+			 hb_glyph_extents_t *extents,
+			 void *user_data HB_UNUSED)
+{
+  const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
+  _hb_ft_hb_font_check_changed (font, ft_font);
+
+  /* COLR glyphs are never cached. */
+  hb_ft_extents_cache_t *extents_cache = ft_font->extents_cache.get_acquire ();
+  if (likely (extents_cache) && extents_cache->get (glyph, extents))
+    return true;
+
+  // FreeType doesn't return COLR glyph extents.
+  if (hb_ft_is_colr_glyph (font, font_data, glyph))
+    return false;
+
+  hb_lock_t lock (ft_font->lock);
+  float x_mult, y_mult;
+  _hb_ft_get_extents_mults (font, ft_font, &x_mult, &y_mult);
+
+  if (!_hb_ft_load_glyph_extents (ft_font, glyph, x_mult, y_mult, extents))
+    return false;
+  if (likely (extents_cache))
+    extents_cache->set (glyph, *extents);
+  return true;
+}
+
+static hb_bool_t
+hb_ft_get_glyph_extents_batch (hb_font_t *font,
+			       void *font_data,
+			       unsigned int count,
+			       const hb_codepoint_t *first_glyph,
+			       unsigned glyph_stride,
+			       hb_glyph_extents_t *first_extents,
+			       unsigned extents_stride,
+			       void *user_data HB_UNUSED)
+{
+  const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
+  _hb_ft_hb_font_check_changed (font, ft_font);
+
+  hb_ft_extents_cache_t *extents_cache = ft_font->extents_cache.get_acquire ();
+  float x_mult = 1.f, y_mult = 1.f;
+  bool locked = false;
+
+  bool ret = true;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    hb_codepoint_t glyph = *first_glyph;
+
+    if (likely (extents_cache) && extents_cache->get (glyph, first_extents))
+    {}
+    // FreeType doesn't return COLR glyph extents.
+    else if (hb_ft_is_colr_glyph (font, font_data, glyph))
+    {
+      hb_memset (first_extents, 0, sizeof (*first_extents));
+      ret = false;
+    }
+    else
+    {
+      if (!locked)
+      {
+	ft_font->lock.lock ();
+	locked = true;
+	_hb_ft_get_extents_mults (font, ft_font, &x_mult, &y_mult);
+      }
+      if (_hb_ft_load_glyph_extents (ft_font, glyph, x_mult, y_mult, first_extents))
+      {
+	if (likely (extents_cache))
+	  extents_cache->set (glyph, *first_extents);
+      }
+      else
+      {
+	hb_memset (first_extents, 0, sizeof (*first_extents));
+	ret = false;
+      }
+    }
+
+    first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+    first_extents = &StructAtOffsetUnaligned<hb_glyph_extents_t> (first_extents, extents_stride);
+  }
+  if (locked)
+    ft_font->lock.unlock ();
+  return ret;
+}
+
 static hb_bool_t
 hb_ft_get_glyph_contour_point (hb_font_t *font HB_UNUSED,
 			       void *font_data,
@@ -737,6 +1021,10 @@ hb_ft_get_glyph_contour_point (hb_font_t *font HB_UNUSED,
   const hb_ft_font_t *ft_font = (const hb_ft_font_t *) font_data;
   _hb_ft_hb_font_check_changed (font, ft_font);
 
+  hb_ft_contour_point_cache_t *point_cache = ft_font->contour_point_cache.get_acquire ();
+  if (point_cache && point_cache->get (glyph, point_index, x, y))
+    return true;
+
   hb_lock_t lock (ft_font->lock);
   FT_Face ft_face = ft_font->ft_face;
 
@@ -752,6 +1040,9 @@ hb_ft_get_glyph_contour_point (hb_font_t *font HB_UNUSED,
   *x = ft_face->glyph->outline.points[point_index].x;
   *y = ft_face->glyph->outline.points[point_index].y;
 
+  if ((point_cache = ft_font->get_contour_point_cache ()))
+    point_cache->set (glyph, point_index, *x, *y);
+
   return true;
 }
 
@@ -1047,6 +1338,7 @@ static struct hb_ft_font_funcs_lazy_loader_t : hb_font_funcs_lazy_loader_t<hb_ft
     hb_font_funcs_set_glyph_h_kerning_func (funcs, hb_ft_get_glyph_h_kerning, nullptr, nullptr);
 #endif
     hb_font_funcs_set_glyph_extents_func (funcs, hb_ft_get_glyph_extents, nullptr, nullptr);
+    hb_font_funcs_set_glyph_extents_batch_func (funcs, hb_ft_get_glyph_extents_batch, nullptr, nullptr);
     hb_font_funcs_set_glyph_contour_point_func (funcs, hb_ft_get_glyph_contour_point, nullptr, nullptr);
     hb_font_funcs_set_glyph_name_func (funcs, hb_ft_get_glyph_name, nullptr, nullptr);
     hb_font_funcs_set_glyph_from_name_func (funcs, hb_ft_get_glyph_from_name, nullptr, nullptr);
@@ -1401,8 +1693,12 @@ hb_ft_font_changed (hb_font_t *font)
   }
 #endif
 
-  ft_font->advance_cache.clear ();
-  ft_font->cached_serial = font->serial;
+  hb_lock_t lock (ft_font->lock);
+  /* The charmap might have changed as well. */
+  if (auto *nominals = ft_font->nominal_cache.get_relaxed ())
+    nominals->clear ();
+  ft_font->reset_caches (font);
+  ft_font->cached_serial.set_release (font->serial.get_acquire ());
 }
 
 /**
@@ -104,9 +104,45 @@
 #define HB_CFF_MAX_OPS 200000
 #endif
 
+#ifndef HB_OT_LAYOUT_SUBTABLE_INDEX_MIN_SUBTABLES
+#define HB_OT_LAYOUT_SUBTABLE_INDEX_MIN_SUBTABLES 8
+#endif
+#ifndef HB_OT_LAYOUT_SUBTABLE_INDEX_MAX_SIZE
+#define HB_OT_LAYOUT_SUBTABLE_INDEX_MAX_SIZE 65536 /* In bytes, per lookup. */
+#endif
+
+#ifndef HB_BSEARCH_BRANCHLESS_MIN_LENGTH
+#define HB_BSEARCH_BRANCHLESS_MIN_LENGTH 32 /* Shorter arrays use plain bfind(). */
+#endif
+
+#ifndef HB_SHAPE_PLAN_CACHE_CAPACITY_DEFAULT
+#define HB_SHAPE_PLAN_CACHE_CAPACITY_DEFAULT 512
+#endif
+#ifndef HB_FONT_FROZEN_SHAPE_PLANS
+#define HB_FONT_FROZEN_SHAPE_PLANS 8
+#endif
+
+#ifndef HB_OT_FACE_MAX_INSTANCES
+#define HB_OT_FACE_MAX_INSTANCES 8 /* Variation instances with shared metrics caches, per face. */
+#endif
+
+#ifndef HB_FONT_GLYPH_CACHE_BITS_DEFAULT
+#define HB_FONT_GLYPH_CACHE_BITS_DEFAULT 8 /* 256 entries. */
+#endif
+#ifndef HB_FONT_GLYPH_CACHE_BITS_LARGE
+#define HB_FONT_GLYPH_CACHE_BITS_LARGE 12 /* 4096 entries, for CJK. */
+#endif
+
 #ifndef HB_MAX_COMPOSITE_OPERATIONS_PER_GLYPH
 #define HB_MAX_COMPOSITE_OPERATIONS_PER_GLYPH 64
 #endif
 
+#ifndef HB_OT_VAR_BLEND_MAX_SAMPLES
+#define HB_OT_VAR_BLEND_MAX_SAMPLES 64
+#endif
+#ifndef HB_OT_VAR_BLEND_NONLINEAR_SAMPLES
+#define HB_OT_VAR_BLEND_NONLINEAR_SAMPLES 16 /* For variations that are not piecewise linear. */
+#endif
+
 
 #endif /* HB_LIMITS_HH */
@@ -534,6 +534,58 @@ struct CmapSubtableFormat4
       glyphIdArrayLength = (subtable->length - 16 - 8 * segCount) / 2;
     }
 
+    /* Whether the segments are sorted and don't overlap, as the spec
+     * requires.  Only then can batched lookups remember the last
+     * segment and search without branches, and still find the same
+     * segment as get_glyph() would. */
+    bool segments_sorted () const
+    {
+      for (unsigned i = 0; i < segCount; i++)
+	if (startCount[i] > endCount[i] ||
+	    (i && endCount[i - 1] >= startCount[i]))
+	  return false;
+      return true;
+    }
+
+    /* The segment the last batched lookup found.  Text tends to stay
+     * within a script, so consecutive codepoints often share one. */
+    struct hint_t
+    {
+      hb_codepoint_t start = 1;
+      hb_codepoint_t end = 0;
+      unsigned index = 0;
+    };
+
+    /* Like get_glyph(), for segments_sorted() subtables only. */
+    bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph, hint_t &hint) const
+    {
+      if (codepoint < hint.start || codepoint > hint.end)
+      {
+	/* Branch-free search for the first segment ending at or after
+	 * codepoint; see hb_sorted_array_t::bfind_branchless(). */
+	const HBUINT16 *base = endCount;
+	unsigned n = segCount;
+	while (n > 8)
+	{
+	  unsigned half = n / 2;
+	  base = base[half] < codepoint ? base + half : base;
+	  n -= half;
+	}
+	unsigned i = base - endCount;
+	for (unsigned j = 0; j < n; j++)
+	  i += base[j] < codepoint;
+
+	if (unlikely (i >= segCount))
+	  return false;
+	hint.start = startCount[i];
+	hint.end = endCount[i];
+	hint.index = i;
+	if (codepoint < hint.start)
+	  return false;
+      }
+      return get_glyph_in_segment (hint.index, codepoint, glyph);
+    }
+
     bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph) const
     {
       struct CustomRange
@@ -556,8 +608,11 @@ struct CmapSubtableFormat4
 					  this->segCount + 1);
       if (unlikely (!found))
 	return false;
-      unsigned int i = found - endCount;
+      return get_glyph_in_segment (found - endCount, codepoint, glyph);
+    }
 
+    bool get_glyph_in_segment (unsigned int i, hb_codepoint_t codepoint, hb_codepoint_t *glyph) const
+    {
       hb_codepoint_t gid;
       unsigned int rangeOffset = this->idRangeOffset[i];
       if (rangeOffset == 0)
@@ -754,6 +809,7 @@ struct CmapSubtableLongGroup
     if (codepoint > endCharCode)   return +1;
     return 0;
   }
+  bool lt (hb_codepoint_t codepoint) const { return endCharCode < codepoint; }
 
   bool sanitize (hb_sanitize_context_t *c) const
   {
@@ -848,6 +904,36 @@ struct CmapSubtableLongSegmented
     return true;
   }
 
+  /* Whether the groups are sorted and don't overlap, as the spec
+   * requires; see CmapSubtableFormat4::accelerator_t::segments_sorted(). */
+  bool groups_sorted () const
+  {
+    unsigned count = groups.len;
+    for (unsigned i = 0; i < count; i++)
+      if (groups.arrayZ[i].startCharCode > groups.arrayZ[i].endCharCode ||
+	  (i && groups.arrayZ[i - 1].endCharCode >= groups.arrayZ[i].startCharCode))
+	return false;
+    return true;
+  }
+
+  /* The group the last batched lookup found. */
+  struct hint_t
+  {
+    const CmapSubtableLongGroup *group = &Null (CmapSubtableLongGroup);
+  };
+
+  /* Like get_glyph(), for groups_sorted() subtables only. */
+  bool get_glyph (hb_codepoint_t codepoint, hb_codepoint_t *glyph, hint_t &hint) const
+  {
+    if (hint.group->cmp (codepoint))
+      hint.group = groups.as_array ().bsearch_branchless (codepoint, &Null (CmapSubtableLongGroup));
+    hb_codepoint_t gid = T::group_get_glyph (*hint.group, codepoint);
+    if (unlikely (!gid))
+      return false;
+    *glyph = gid;
+    return true;
+  }
+
   unsigned get_language () const
   {
     return language;
@@ -2072,28 +2158,166 @@ struct cmap
 	    break;
 	  case 12:
 	    this->get_glyph_funcZ = get_glyph_from<CmapSubtableFormat12>;
+	    if (subtable->u.format12.groups_sorted ())
+	      this->batch_format = 12;
 	    break;
 	  case  4:
 	  {
 	    this->format4_accel.init (&subtable->u.format4);
 	    this->get_glyph_data = &this->format4_accel;
 	    this->get_glyph_funcZ = this->format4_accel.get_glyph_func;
+	    if (this->format4_accel.segments_sorted ())
+	      this->batch_format = 4;
 	    break;
 	  }
 	}
       }
+
+      /* The page table is filled from the hinted lookups, so it needs
+       * a sorted format 4 or format 12 subtable too. */
+      this->use_page_table = face->cmap_page_table && this->batch_format;
     }
     ~accelerator_t ()
     {
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
       hb_free (cache);
 #endif
+      hb_free (page_table.get_relaxed ());
       table.destroy ();
     }
 
+    /* Dense two-level map of the BMP, for faces that opted in with
+     * hb_face_set_cmap_page_table().  Only populated pages are stored;
+     * the rest share the all-zero page 0, so a lookup is two indexed
+     * loads.  Glyph 0 means unmapped. */
+    struct page_table_t
+    {
+      static constexpr unsigned PAGE_BITS = 8;
+      static constexpr unsigned PAGE_SIZE = 1u << PAGE_BITS;
+      static constexpr unsigned NUM_PAGES = 0x10000u >> PAGE_BITS;
+
+      struct page_t { uint16_t glyphs[PAGE_SIZE]; };
+
+      static unsigned get_size (unsigned num_pages)
+      { return sizeof (page_table_t) + (num_pages - HB_VAR_ARRAY) * sizeof (page_t); }
+      unsigned get_size () const { return get_size (num_pages); }
+
+      /* @unicode must be in the BMP. */
+      hb_codepoint_t get (hb_codepoint_t unicode) const
+      { return pages[page_index[unicode >> PAGE_BITS]].glyphs[unicode & (PAGE_SIZE - 1)]; }
+
+      unsigned num_pages; /* Including page 0. */
+      uint16_t page_index[NUM_PAGES];
+      page_t pages[HB_VAR_ARRAY];
+    };
+
+    template <typename Type>
+    static page_table_t *_create_page_table (const Type &typed_obj)
+    {
+      constexpr unsigned PAGE_BITS = page_table_t::PAGE_BITS;
+      constexpr unsigned PAGE_SIZE = page_table_t::PAGE_SIZE;
+
+      uint16_t page_index[page_table_t::NUM_PAGES];
+      unsigned num_pages = 1;
+      {
+	typename Type::hint_t hint;
+	for (unsigned page = 0; page < page_table_t::NUM_PAGES; page++)
+	{
+	  page_index[page] = 0;
+	  for (hb_codepoint_t u = page << PAGE_BITS; u < (page + 1) << PAGE_BITS; u++)
+	  {
+	    hb_codepoint_t glyph;
+	    if (!typed_obj.get_glyph (u, &glyph, hint))
+	      continue;
+	    /* Only format 12 can map past 16 bits; leave such fonts be. */
+	    if (unlikely (glyph > 0xFFFFu))
+	      return nullptr;
+	    page_index[page] = num_pages++;
+	    break;
+	  }
+	}
+      }
+
+      page_table_t *page_table = (page_table_t *) hb_calloc (1, page_table_t::get_size (num_pages));
+      if (unlikely (!page_table))
+	return nullptr;
+      page_table->num_pages = num_pages;
+      hb_memcpy (page_table->page_index, page_index, sizeof (page_index));
+
+      typename Type::hint_t hint;
+      for (unsigned page = 0; page < page_table_t::NUM_PAGES; page++)
+      {
+	if (!page_index[page])
+	  continue;
+	uint16_t *glyphs = page_table->pages[page_index[page]].glyphs;
+	for (unsigned i = 0; i < PAGE_SIZE; i++)
+	{
+	  hb_codepoint_t glyph;
+	  if (typed_obj.get_glyph ((page << PAGE_BITS) + i, &glyph, hint))
+	  {
+	    if (unlikely (glyph > 0xFFFFu))
+	    {
+	      hb_free (page_table);
+	      return nullptr;
+	    }
+	    glyphs[i] = glyph;
+	  }
+	}
+      }
+      return page_table;
+    }
+
+    const page_table_t *get_page_table () const
+    {
+      if (!use_page_table)
+	return nullptr;
+
+    retry:
+      page_table_t *p = page_table.get_acquire ();
+      if (likely (p))
+	return p;
+
+      switch (this->batch_format)
+      {
+	case  4: p = _create_page_table (this->format4_accel); break;
+	case 12: p = _create_page_table (this->subtable->u.format12); break;
+	default: break;
+      }
+      if (unlikely (!p))
+      {
+	/* Out of memory, or not representable; don't try again. */
+	use_page_table = false;
+	return nullptr;
+      }
+
+      if (unlikely (!page_table.cmpexch (nullptr, p)))
+      {
+	hb_free (p);
+	goto retry;
+      }
+      return p;
+    }
+
+    /* Bytes used by the page table; 0 if it is not in use or not built yet. */
+    unsigned get_page_table_size () const
+    {
+      const page_table_t *p = use_page_table ? page_table.get_acquire () : nullptr;
+      return p ? p->get_size () : 0;
+    }
+
     inline bool _cached_get (hb_codepoint_t unicode,
 			     hb_codepoint_t *glyph) const
     {
+      if (unicode <= 0xFFFFu && use_page_table)
+	if (const page_table_t *p = get_page_table ())
+	{
+	  hb_codepoint_t gid = p->get (unicode);
+	  if (!gid)
+	    return false;
+	  *glyph = gid;
+	  return true;
+	}
+
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
       // cache is always non-null if we have a get_glyph_funcZ
       unsigned v;
@@ -2128,6 +2352,26 @@ struct cmap
     {
       if (unlikely (!this->get_glyph_funcZ)) return 0;
 
+      if (use_page_table)
+	if (const page_table_t *p = get_page_table ())
+	  return _get_nominal_glyphs_paged (p,
+					    count,
+					    first_unicode, unicode_stride,
+					    first_glyph, glyph_stride);
+
+      switch (this->batch_format)
+      {
+	case  4: return _get_nominal_glyphs_hinted (this->format4_accel,
+						    count,
+						    first_unicode, unicode_stride,
+						    first_glyph, glyph_stride);
+	case 12: return _get_nominal_glyphs_hinted (this->subtable->u.format12,
+						    count,
+						    first_unicode, unicode_stride,
+						    first_glyph, glyph_stride);
+	default: break;
+      }
+
       unsigned int done;
       for (done = 0;
 	   done < count && _cached_get (*first_unicode, first_glyph);
@@ -2139,6 +2383,68 @@ struct cmap
       return done;
     }
 
+    /* Runs of text mostly map through the same few segments / groups;
+     * remember the last one, and search sorted subtables branch-free
+     * on a miss. */
+    template <typename Type>
+    unsigned int _get_nominal_glyphs_hinted (const Type &typed_obj,
+					     unsigned int count,
+					     const hb_codepoint_t *first_unicode,
+					     unsigned int unicode_stride,
+					     hb_codepoint_t *first_glyph,
+					     unsigned int glyph_stride) const
+    {
+      typename Type::hint_t hint;
+
+      unsigned int done;
+      for (done = 0; done < count; done++)
+      {
+	hb_codepoint_t unicode = *first_unicode;
+#ifndef HB_NO_OT_FONT_CMAP_CACHE
+	unsigned v;
+	if (cache->get (unicode, &v))
+	  *first_glyph = v;
+	else
+#endif
+	{
+	  if (!typed_obj.get_glyph (unicode, first_glyph, hint))
+	    break;
+#ifndef HB_NO_OT_FONT_CMAP_CACHE
+	  cache->set (unicode, *first_glyph);
+#endif
+	}
+	first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
+	first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      }
+      return done;
+    }
+
+    unsigned int _get_nominal_glyphs_paged (const page_table_t *p,
+					    unsigned int count,
+					    const hb_codepoint_t *first_unicode,
+					    unsigned int unicode_stride,
+					    hb_codepoint_t *first_glyph,
+					    unsigned int glyph_stride) const
+    {
+      unsigned int done;
+      for (done = 0; done < count; done++)
+      {
+	hb_codepoint_t unicode = *first_unicode;
+	if (likely (unicode <= 0xFFFFu))
+	{
+	  hb_codepoint_t gid = p->get (unicode);
+	  if (!gid)
+	    break;
+	  *first_glyph = gid;
+	}
+	else if (!_cached_get (unicode, first_glyph))
+	  break;
+	first_unicode = &StructAtOffsetUnaligned<hb_codepoint_t> (first_unicode, unicode_stride);
+	first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+      }
+      return done;
+    }
+
     bool get_variation_glyph (hb_codepoint_t  unicode,
 			      hb_codepoint_t  variation_selector,
 			      hb_codepoint_t *glyph) const
@@ -2226,6 +2532,11 @@ struct cmap
     const void *get_glyph_data = nullptr;
 
     CmapSubtableFormat4::accelerator_t format4_accel;
+    /* Subtable format whose hinted get_glyph() get_nominal_glyphs()
+     * may use; 0 for none. */
+    unsigned batch_format = 0;
+    mutable hb_atomic_t<bool> use_page_table;
+    mutable hb_atomic_t<page_table_t *> page_table;
 
 #ifndef HB_NO_OT_FONT_CMAP_CACHE
     cache_t *cache = nullptr;
@@ -25,12 +25,21 @@
  */
 
 #include "hb-ot-face.hh"
+#include "hb-mutex.hh"
 
 #include "hb-ot-cmap-table.hh"
 #include "hb-ot-glyf-table.hh"
 #include "hb-ot-cff1-table.hh"
 #include "hb-ot-cff2-table.hh"
 #include "hb-ot-hmtx-table.hh"
+#include "hb-ot-head-table.hh"
+#include "hb-ot-maxp-table.hh"
+#include "hb-ot-os2-table.hh"
+#include "hb-ot-vorg-table.hh"
+#include "hb-ot-var-avar-table.hh"
+#include "hb-ot-var-fvar-table.hh"
+#include "hb-ot-var-gvar-table.hh"
+#include "hb-ot-var-mvar-table.hh"
 #include "hb-ot-kern-table.hh"
 #include "hb-ot-meta-table.hh"
 #include "hb-ot-name-table.hh"
@@ -45,18 +54,215 @@
 #include "hb-ot-var-varc-table.hh"
 #include "hb-aat-layout-kerx-table.hh"
 #include "hb-aat-layout-morx-table.hh"
+#include "hb-aat-layout-ankr-table.hh"
+#include "hb-aat-layout-trak-table.hh"
 
 
+static void
+_hb_ot_face_instance_destroy (hb_ot_face_instance_t *instance)
+{
+  if (!instance)
+    return;
+  instance->~hb_ot_face_instance_t ();
+  hb_free (instance);
+}
+
+static hb_ot_face_instance_t *
+_hb_ot_face_instance_create (const int *coords, unsigned num_coords)
+{
+  hb_ot_face_instance_t *instance = (hb_ot_face_instance_t *) hb_calloc (1, sizeof (hb_ot_face_instance_t));
+  if (unlikely (!instance))
+    return nullptr;
+  new (instance) hb_ot_face_instance_t ();
+
+  instance->h_advances = hb_ot_face_instance_t::advance_cache_t::create (HB_FONT_GLYPH_CACHE_BITS_DEFAULT);
+  instance->v_advances = hb_ot_face_instance_t::advance_cache_t::create (HB_FONT_GLYPH_CACHE_BITS_DEFAULT);
+  if (unlikely (!instance->h_advances ||
+		!instance->v_advances ||
+		!instance->coords.resize_exact (num_coords)))
+  {
+    _hb_ot_face_instance_destroy (instance);
+    return nullptr;
+  }
+  hb_memcpy (instance->coords.arrayZ, coords, num_coords * sizeof (coords[0]));
+
+  return instance;
+}
+
+struct hb_ot_face_instances_t
+{
+  ~hb_ot_face_instances_t ()
+  {
+    for (auto *instance : slots)
+      _hb_ot_face_instance_destroy (instance);
+  }
+
+  hb_mutex_t lock;
+  hb_ot_face_instance_t *slots[HB_OT_FACE_MAX_INSTANCES] = {};
+  unsigned clock = 0;
+};
+
 void hb_ot_face_t::init0 (hb_face_t *face)
 {
   this->face = face;
 #define HB_OT_TABLE(Namespace, Type) Type.init0 ();
 #include "hb-ot-face-table-list.hh"
 #undef HB_OT_TABLE
+  glyph_sources.set_relaxed (0);
+  instances.set_relaxed (nullptr);
 }
 void hb_ot_face_t::fini ()
 {
 #define HB_OT_TABLE(Namespace, Type) Type.fini ();
 #include "hb-ot-face-table-list.hh"
 #undef HB_OT_TABLE
+  if (auto *instances_ = instances.get_relaxed ())
+  {
+    instances_->~hb_ot_face_instances_t ();
+    hb_free (instances_);
+  }
+}
+void hb_ot_face_t::warm ()
+{
+  /* Only the tables shaping and glyph metrics and outlines use. */
+  head.get_stored ();
+  maxp.get_stored ();
+#if !defined(HB_NO_FACE_COLLECT_UNICODES) || !defined(HB_NO_OT_FONT)
+  cmap.get_stored ();
+#endif
+  hhea.get_stored ();
+  hmtx.get_stored ();
+  OS2.get_stored ();
+#ifndef HB_NO_VERTICAL
+  vhea.get_stored ();
+  vmtx.get_stored ();
+  VORG.get_stored ();
+#endif
+  loca.get_stored ();
+  glyf.get_stored ();
+#ifndef HB_NO_CFF
+  cff1.get_stored ();
+  cff2.get_stored ();
+#endif
+#ifndef HB_NO_VAR
+  fvar.get_stored ();
+  avar.get_stored ();
+  gvar.get_stored ();
+#ifndef HB_NO_BEYOND_64K
+  GVAR.get_stored ();
+#endif
+  MVAR.get_stored ();
+#ifndef HB_NO_VAR_COMPOSITES
+  VARC.get_stored ();
+#endif
+#endif
+#ifndef HB_NO_OT_KERN
+  kern.get_stored ();
+#endif
+#ifndef HB_NO_OT_LAYOUT
+  GDEF.get_stored ();
+  GSUB.get_stored ();
+  GPOS.get_stored ();
+#endif
+#ifndef HB_NO_AAT
+  morx.get_stored ();
+  mort.get_stored ();
+  kerx.get_stored ();
+  ankr.get_stored ();
+  trak.get_stored ();
+#endif
+}
+
+unsigned hb_ot_face_t::resolve_glyph_sources () const
+{
+  unsigned sources = GLYPH_SOURCE_RESOLVED;
+
+#ifndef HB_NO_COLOR
+#ifndef HB_NO_OT_FONT_BITMAP
+  if (sbix->has_data ()) sources |= GLYPH_SOURCE_sbix;
+  if (CBDT->has_data ()) sources |= GLYPH_SOURCE_CBDT;
+#endif
+  if (COLR->has_data ()) sources |= GLYPH_SOURCE_COLR;
+  if (SVG->has_data ()) sources |= GLYPH_SOURCE_SVG;
+#endif
+#ifndef HB_NO_VAR_COMPOSITES
+  if (VARC->has_data ()) sources |= GLYPH_SOURCE_VARC;
+#endif
+  if (glyf->has_data ()) sources |= GLYPH_SOURCE_glyf;
+#ifndef HB_NO_CFF
+  if (cff2->is_valid ()) sources |= GLYPH_SOURCE_cff2;
+  if (cff1->is_valid ()) sources |= GLYPH_SOURCE_cff1;
+#endif
+
+  if (likely (face)) /* Don't write to the Null face. */
+    glyph_sources.set_relaxed (sources);
+  return sources;
+}
+
+hb_ot_face_instance_t *
+hb_ot_face_t::get_instance (const int *coords, unsigned num_coords) const
+{
+  if (unlikely (!face)) /* Don't write to the Null face. */
+    return nullptr;
+
+retry:
+  auto *instances_ = instances.get_acquire ();
+  if (unlikely (!instances_))
+  {
+    instances_ = (hb_ot_face_instances_t *) hb_calloc (1, sizeof (hb_ot_face_instances_t));
+    if (unlikely (!instances_))
+      return nullptr;
+    instances_ = new (instances_) hb_ot_face_instances_t ();
+    if (unlikely (!instances.cmpexch (nullptr, instances_)))
+    {
+      instances_->~hb_ot_face_instances_t ();
+      hb_free (instances_);
+      goto retry;
+    }
+  }
+
+  hb_lock_t lock (instances_->lock);
+
+  /* Pick the matching instance, or else an empty slot, or else the
+   * least recently used idle instance to replace. */
+  hb_ot_face_instance_t **victim = nullptr;
+  for (auto &slot : instances_->slots)
+  {
+    if (!slot)
+    {
+      if (!victim || *victim)
+	victim = &slot;
+      continue;
+    }
+    if (slot->matches (coords, num_coords))
+    {
+      slot->users++;
+      slot->last_used = ++instances_->clock;
+      return slot;
+    }
+    if (!slot->users &&
+	(!victim || (*victim && (*victim)->last_used > slot->last_used)))
+      victim = &slot;
+  }
+  if (!victim)
+    return nullptr;
+
+  auto *instance = _hb_ot_face_instance_create (coords, num_coords);
+  if (unlikely (!instance))
+    return nullptr;
+  _hb_ot_face_instance_destroy (*victim);
+  *victim = instance;
+  instance->users = 1;
+  instance->last_used = ++instances_->clock;
+  return instance;
+}
+
+void
+hb_ot_face_t::release_instance (hb_ot_face_instance_t *instance) const
+{
+  if (!instance)
+    return;
+
+  hb_lock_t lock (instances.get_acquire ()->lock);
+  instance->users--;
 }
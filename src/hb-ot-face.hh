@@ -32,6 +32,7 @@
 #include "hb.hh"
 
 #include "hb-machinery.hh"
+#include "hb-cache.hh"
 
 
 /*
@@ -45,10 +46,78 @@
 #undef HB_OT_ACCELERATOR
 #undef HB_OT_TABLE
 
+/* Metrics at one set of variation coordinates, shared by all fonts of
+ * a face that are set to those coordinates.  The caches are lock-free,
+ * so any number of fonts, on any threads, can use them at once. */
+struct hb_ot_face_instance_t
+{
+  using advance_cache_t = hb_sized_cache_t<24, 16,
+					   HB_FONT_GLYPH_CACHE_BITS_DEFAULT,
+					   HB_FONT_GLYPH_CACHE_BITS_LARGE>;
+
+  ~hb_ot_face_instance_t ()
+  {
+    advance_cache_t::destroy (h_advances);
+    advance_cache_t::destroy (v_advances);
+  }
+
+  bool matches (const int *coords_, unsigned num_coords) const
+  {
+    return coords.length == num_coords &&
+	   !hb_memcmp (coords.arrayZ, coords_, num_coords * sizeof (coords_[0]));
+  }
+
+  hb_vector_t<int> coords; /* Normalized. */
+  /* Unscaled, and of the default size; fonts with a larger cache
+   * policy keep their own. */
+  advance_cache_t *h_advances = nullptr;
+  advance_cache_t *v_advances = nullptr;
+
+  /* Guarded by the lock of hb_ot_face_instances_t. */
+  unsigned users = 0;	/* Fonts using the instance. */
+  unsigned last_used = 0;
+};
+struct hb_ot_face_instances_t;
+
 struct hb_ot_face_t
 {
   HB_INTERNAL void init0 (hb_face_t *face);
   HB_INTERNAL void fini ();
+  /* Loads the tables shaping needs now, instead of on first use. */
+  HB_INTERNAL void warm ();
+
+  /* The tables a glyph's extents, outline or color paint can come from.
+   * Resolved once per face, so lookups can skip the tables the face
+   * doesn't have instead of probing each of them for every glyph. */
+  enum glyph_source_t
+  {
+    GLYPH_SOURCE_RESOLVED	= 1u << 0,
+    GLYPH_SOURCE_sbix		= 1u << 1,
+    GLYPH_SOURCE_CBDT		= 1u << 2,
+    GLYPH_SOURCE_COLR		= 1u << 3,
+    GLYPH_SOURCE_SVG		= 1u << 4,
+    GLYPH_SOURCE_VARC		= 1u << 5,
+    GLYPH_SOURCE_glyf		= 1u << 6,
+    GLYPH_SOURCE_cff2		= 1u << 7,
+    GLYPH_SOURCE_cff1		= 1u << 8,
+  };
+  unsigned get_glyph_sources () const
+  {
+    unsigned sources = glyph_sources.get_relaxed ();
+    if (unlikely (!sources))
+      sources = resolve_glyph_sources ();
+    return sources;
+  }
+  HB_INTERNAL unsigned resolve_glyph_sources () const;
+
+  /* Returns the shared instance for the given normalized coordinates,
+   * creating it if needed; release it with release_instance().  The
+   * face keeps up to HB_OT_FACE_MAX_INSTANCES of them, replacing the
+   * least recently used one that no font uses anymore when full.  If
+   * all are in use, new coordinates get nullptr. */
+  HB_INTERNAL hb_ot_face_instance_t *get_instance (const int *coords,
+						   unsigned num_coords) const;
+  HB_INTERNAL void release_instance (hb_ot_face_instance_t *instance) const;
 
 #define HB_OT_TABLE_ORDER(Namespace, Type) \
     HB_PASTE (ORDER_, HB_PASTE (Namespace, HB_PASTE (_, Type)))
@@ -71,6 +140,11 @@ struct hb_ot_face_t
 #undef HB_OT_ACCELERATOR
 #undef HB_OT_CORE_TABLE
 #undef HB_OT_TABLE
+
+  private:
+  mutable hb_atomic_t<unsigned> glyph_sources;
+  /* Created on first use. */
+  mutable hb_atomic_t<hb_ot_face_instances_t *> instances;
 };
 
 
@@ -62,14 +62,59 @@
  * never need to call these functions directly.
  **/
 
-using hb_ot_font_advance_cache_t = hb_cache_t<24, 16>;
-static_assert (sizeof (hb_ot_font_advance_cache_t) == 1024, "");
+/* Sized by the font's cache policy. */
+using hb_ot_font_advance_cache_t = hb_ot_face_instance_t::advance_cache_t;
 
 using hb_ot_font_origin_cache_t = hb_cache_t<20, 20>;
 static_assert (sizeof (hb_ot_font_origin_cache_t) == 1024, "");
 
+/* Extents don't fit in an hb_cache_t item, so each field gets a cache
+ * of its own, as in hb-ft.  A glyph's fields don't change until the
+ * cache is cleared, so a lookup can't see a mix of fields from different
+ * glyphs, even if threads race storing them.  That makes it safe to
+ * share in place once the font is frozen. */
+struct hb_ot_font_extents_cache_t
+{
+  using cache_t = hb_cache_t<16, 24>;
+  static constexpr int BIAS = 1 << 23;
+
+  void clear ()
+  {
+    x_bearing.clear ();
+    y_bearing.clear ();
+    width.clear ();
+    height.clear ();
+  }
+
+  bool get (hb_codepoint_t glyph, hb_glyph_extents_t *extents) const
+  {
+    unsigned xb, yb, w, h;
+    if (!x_bearing.get (glyph, &xb) || !y_bearing.get (glyph, &yb) ||
+	!width.get (glyph, &w) || !height.get (glyph, &h))
+      return false;
+    extents->x_bearing = (int) xb - BIAS;
+    extents->y_bearing = (int) yb - BIAS;
+    extents->width = (int) w - BIAS;
+    extents->height = (int) h - BIAS;
+    return true;
+  }
+
+  /* Glyphs above 65535, or fields out of range, aren't stored. */
+  void set (hb_codepoint_t glyph, const hb_glyph_extents_t &extents)
+  {
+    x_bearing.set (glyph, (unsigned) (extents.x_bearing + BIAS));
+    y_bearing.set (glyph, (unsigned) (extents.y_bearing + BIAS));
+    width.set (glyph, (unsigned) (extents.width + BIAS));
+    height.set (glyph, (unsigned) (extents.height + BIAS));
+  }
+
+  private:
+  cache_t x_bearing, y_bearing, width, height;
+};
+
 struct hb_ot_font_t
 {
+  hb_face_t *face; /* Referenced. */
   const hb_ot_face_t *ot_face;
 
   mutable hb_atomic_t<int> cached_serial;
@@ -79,35 +124,43 @@ struct hb_ot_font_t
   {
     mutable hb_atomic_t<hb_ot_font_advance_cache_t *> advance_cache;
     mutable hb_atomic_t<OT::hb_scalar_cache_t *> varStore_cache;
+    /* The face-level cache for the font's coordinates, if any, or the
+     * font's own one once frozen.  It is thread-safe, so is used in
+     * place instead of taken out. */
+    mutable hb_atomic_t<hb_ot_font_advance_cache_t *> shared_advance_cache;
+    bool frozen;
 
     ~direction_cache_t ()
     {
       clear ();
     }
 
-    hb_ot_font_advance_cache_t *acquire_advance_cache () const
+    hb_ot_font_advance_cache_t *acquire_advance_cache (unsigned cache_bits) const
     {
+      if (auto *shared = shared_advance_cache.get_relaxed ())
+        return shared;
     retry:
       auto *cache = advance_cache.get_acquire ();
       if (!cache)
-      {
-        cache = (hb_ot_font_advance_cache_t *) hb_malloc (sizeof (hb_ot_font_advance_cache_t));
-	if (!cache)
-	  return nullptr;
-	new (cache) hb_ot_font_advance_cache_t;
-	return cache;
-      }
+	return hb_ot_font_advance_cache_t::create (cache_bits);
       if (advance_cache.cmpexch (cache, nullptr))
+      {
+	if (unlikely (cache->get_cache_bits () != cache_bits))
+	{
+	  hb_ot_font_advance_cache_t::destroy (cache);
+	  return hb_ot_font_advance_cache_t::create (cache_bits);
+	}
         return cache;
+      }
       else
         goto retry;
     }
     void release_advance_cache (hb_ot_font_advance_cache_t *cache) const
     {
-      if (!cache)
+      if (!cache || cache == shared_advance_cache.get_relaxed ())
         return;
       if (!advance_cache.cmpexch (nullptr, cache))
-        hb_free (cache);
+        hb_ot_font_advance_cache_t::destroy (cache);
     }
     void clear_advance_cache () const
     {
@@ -116,13 +169,15 @@ struct hb_ot_font_t
       if (!cache)
 	return;
       if (advance_cache.cmpexch (cache, nullptr))
-	hb_free (cache);
+	hb_ot_font_advance_cache_t::destroy (cache);
       else
         goto retry;
     }
 
     OT::hb_scalar_cache_t *acquire_varStore_cache (const OT::ItemVariationStore &varStore) const
     {
+      if (frozen)
+	return nullptr;
     retry:
       auto *cache = varStore_cache.get_acquire ();
       if (!cache)
@@ -153,16 +208,32 @@ struct hb_ot_font_t
 
     void clear () const
     {
+      shared_advance_cache.set_relaxed (nullptr);
       clear_advance_cache ();
       clear_varStore_cache ();
     }
 
+    /* Keeps our own advance cache in the slot, and shares it. */
+    void freeze (unsigned cache_bits)
+    {
+      if (!shared_advance_cache.get_relaxed ())
+	if (auto *cache = acquire_advance_cache (cache_bits))
+	{
+	  advance_cache.set_relaxed (cache);
+	  shared_advance_cache.set_relaxed (cache);
+	}
+      frozen = true;
+    }
+
   } h, v;
 
   struct origin_cache_t
   {
     mutable hb_atomic_t<hb_ot_font_origin_cache_t *> origin_cache;
     mutable hb_atomic_t<OT::hb_scalar_cache_t *> varStore_cache;
+    /* Once frozen, the origin cache is shared in place, like the
+     * advance caches; the varStore cache is not used. */
+    bool frozen;
 
     ~origin_cache_t ()
     {
@@ -171,6 +242,8 @@ struct hb_ot_font_t
 
     hb_ot_font_origin_cache_t *acquire_origin_cache () const
     {
+      if (frozen)
+	return origin_cache.get_relaxed ();
     retry:
       auto *cache = origin_cache.get_acquire ();
       if (!cache)
@@ -188,7 +261,7 @@ struct hb_ot_font_t
     }
     void release_origin_cache (hb_ot_font_origin_cache_t *cache) const
     {
-      if (!cache)
+      if (!cache || frozen)
         return;
       if (!origin_cache.cmpexch (nullptr, cache))
         hb_free (cache);
@@ -207,6 +280,8 @@ struct hb_ot_font_t
 
     OT::hb_scalar_cache_t *acquire_varStore_cache (const OT::ItemVariationStore &varStore) const
     {
+      if (frozen)
+	return nullptr;
     retry:
       auto *cache = varStore_cache.get_acquire ();
       if (!cache)
@@ -240,11 +315,77 @@ struct hb_ot_font_t
       clear_origin_cache ();
       clear_varStore_cache ();
     }
+
+    void freeze ()
+    {
+      if (!origin_cache.get_relaxed ())
+	origin_cache.set_relaxed (acquire_origin_cache ());
+      frozen = true;
+    }
   } v_origin;
 
+  struct extents_cache_t
+  {
+    mutable hb_atomic_t<hb_ot_font_extents_cache_t *> extents_cache;
+    /* Once frozen, the extents cache is shared in place, like the
+     * origin cache. */
+    bool frozen;
+    ~extents_cache_t ()
+    {
+      clear ();
+    }
+
+    hb_ot_font_extents_cache_t *acquire_extents_cache () const
+    {
+      if (frozen)
+	return extents_cache.get_relaxed ();
+    retry:
+      auto *cache = extents_cache.get_acquire ();
+      if (!cache)
+      {
+        cache = (hb_ot_font_extents_cache_t *) hb_malloc (sizeof (hb_ot_font_extents_cache_t));
+	if (!cache)
+	  return nullptr;
+	new (cache) hb_ot_font_extents_cache_t;
+	return cache;
+      }
+      if (extents_cache.cmpexch (cache, nullptr))
+        return cache;
+      else
+        goto retry;
+    }
+    void release_extents_cache (hb_ot_font_extents_cache_t *cache) const
+    {
+      if (!cache || frozen)
+        return;
+      if (!extents_cache.cmpexch (nullptr, cache))
+        hb_free (cache);
+    }
+
+    void clear () const
+    {
+    retry:
+      auto *cache = extents_cache.get_acquire ();
+      if (!cache)
+	return;
+      if (extents_cache.cmpexch (cache, nullptr))
+	hb_free (cache);
+      else
+        goto retry;
+    }
+
+    void freeze ()
+    {
+      if (!extents_cache.get_relaxed ())
+	extents_cache.set_relaxed (acquire_extents_cache ());
+      frozen = true;
+    }
+  } extents;
+
   struct draw_cache_t
   {
     mutable hb_atomic_t<OT::hb_scalar_cache_t *> gvar_cache;
+    bool frozen; /* Not thread-safe, so not used once frozen. */
 
     ~draw_cache_t ()
     {
@@ -253,6 +394,8 @@ struct hb_ot_font_t
 
     OT::hb_scalar_cache_t *acquire_gvar_cache (const OT::gvar_accelerator_t &gvar) const
     {
+      if (frozen)
+	return nullptr;
     retry:
       auto *cache = gvar_cache.get_acquire ();
       if (!cache)
@@ -287,14 +430,32 @@ struct hb_ot_font_t
     }
   } draw;
 
+  /* The face's instance at the font's coordinates, if shared. */
+  mutable hb_atomic_t<hb_ot_face_instance_t *> instance;
+
+  ~hb_ot_font_t ()
+  {
+    ot_face->release_instance (instance.get_relaxed ());
+    hb_face_destroy (face);
+  }
+
+  void set_instance (hb_ot_face_instance_t *instance_) const
+  {
+    auto *old = instance.get_acquire ();
+    while (!instance.cmpexch (old, instance_))
+      old = instance.get_acquire ();
+    ot_face->release_instance (old);
+  }
+
   void check_serial (hb_font_t *font) const
   {
-    int font_serial = font->serial_coords.get_acquire ();
+    int font_serial = font->serial.get_acquire ();
     if (cached_serial.get_acquire () != font_serial)
     {
       /* These caches are dependent on scale and synthetic settings.
        * Any change to the font invalidates them. */
       v_origin.clear ();
+      extents.clear ();
 
       cached_serial.set_release (font_serial);
     }
@@ -308,9 +469,45 @@ struct hb_ot_font_t
       v.clear ();
       draw.clear ();
 
+      /* Fonts at the same coordinates share their advances, unless
+       * they asked for a larger cache than the shared one. */
+      hb_ot_face_instance_t *instance_ = nullptr;
+      if (font->has_nonzero_coords &&
+	  font->glyph_cache_bits () == HB_FONT_GLYPH_CACHE_BITS_DEFAULT)
+	if ((instance_ = ot_face->get_instance (font->coords, font->num_coords)))
+	{
+	  h.shared_advance_cache.set_relaxed (instance_->h_advances);
+	  v.shared_advance_cache.set_relaxed (instance_->v_advances);
+	}
+      set_instance (instance_);
+
       cached_coords_serial.set_release (font_serial_coords);
     }
   }
+
+  /* See hb_font_warm().  Allocates the glyph caches for the current
+   * font settings, so that the first lookups find them in place. */
+  void warm (hb_font_t *font) const
+  {
+    check_serial (font);
+    h.release_advance_cache (h.acquire_advance_cache (font->glyph_cache_bits ()));
+    v.release_advance_cache (v.acquire_advance_cache (font->glyph_cache_bits ()));
+    v_origin.release_origin_cache (v_origin.acquire_origin_cache ());
+    extents.release_extents_cache (extents.acquire_extents_cache ());
+  }
+
+  /* See hb_font_freeze().  The font doesn't change anymore, so the
+   * thread-safe caches are shared by all threads in place, and the
+   * others aren't used. */
+  void freeze (hb_font_t *font)
+  {
+    check_serial (font);
+    h.freeze (font->glyph_cache_bits ());
+    v.freeze (font->glyph_cache_bits ());
+    v_origin.freeze ();
+    extents.freeze ();
+    draw.frozen = true;
+  }
 };
 
 static hb_ot_font_t *
@@ -320,7 +517,10 @@ _hb_ot_font_create (hb_font_t *font)
   if (unlikely (!ot_font))
     return nullptr;
 
-  ot_font->ot_face = &font->face->table;
+  /* The font may be given another face later; keep ours alive, since
+   * the instance we hold is released through it. */
+  ot_font->face = hb_face_reference (font->face);
+  ot_font->ot_face = &ot_font->face->table;
 
   return ot_font;
 }
@@ -335,6 +535,26 @@ _hb_ot_font_destroy (void *font_data)
   hb_free (ot_font);
 }
 
+void
+_hb_ot_font_warm (hb_font_t *font)
+{
+  if (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy)
+    return;
+
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font->user_data;
+  ot_font->warm (font);
+}
+
+void
+_hb_ot_font_freeze (hb_font_t *font)
+{
+  if (font->destroy != (hb_destroy_func_t) _hb_ot_font_destroy)
+    return;
+
+  hb_ot_font_t *ot_font = (hb_ot_font_t *) font->user_data;
+  ot_font->freeze (font);
+}
+
 static hb_bool_t
 hb_ot_get_nominal_glyph (hb_font_t *font HB_UNUSED,
 			 void *font_data,
@@ -426,7 +646,7 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
   /* has_nonzero_coords. */
 
   ot_font->check_serial (font);
-  hb_ot_font_advance_cache_t *advance_cache = ot_font->h.acquire_advance_cache ();
+  hb_ot_font_advance_cache_t *advance_cache = ot_font->h.acquire_advance_cache (font->glyph_cache_bits ());
   if (!advance_cache)
   {
     // malloc failure. Just use the fallback non-variable path.
@@ -440,6 +660,7 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
     const OT::ItemVariationStore &varStore = &HVAR + HVAR.varStore;
     OT::hb_scalar_cache_t *varStore_cache = ot_font->h.acquire_varStore_cache (varStore);
 
+    unsigned misses = 0;
     for (unsigned int i = 0; i < count; i++)
     {
       hb_position_t v;
@@ -449,12 +670,14 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
       else
       {
         v = hmtx.get_advance_with_var_unscaled (*first_glyph, font, varStore_cache);
+	misses++;
 	advance_cache->set (*first_glyph, v);
       }
       *first_advance = font->em_scale_x (v);
       first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
       first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
     }
+    font->count_advance_cache_lookups (count, misses);
 
     ot_font->h.release_varStore_cache (varStore_cache);
     ot_font->h.release_advance_cache (advance_cache);
@@ -473,6 +696,7 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
     }
     OT::hb_scalar_cache_t *gvar_cache = ot_font->draw.acquire_gvar_cache (gvar);
 
+    unsigned misses = 0;
     for (unsigned int i = 0; i < count; i++)
     {
       hb_position_t v;
@@ -482,12 +706,14 @@ hb_ot_get_glyph_h_advances (hb_font_t* font, void* font_data,
       else
       {
         v = glyf.get_advance_with_var_unscaled (*first_glyph, font, false, *scratch, gvar_cache);
+	misses++;
 	advance_cache->set (*first_glyph, v);
       }
       *first_advance = font->em_scale_x (v);
       first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
       first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
     }
+    font->count_advance_cache_lookups (count, misses);
 
     ot_font->draw.release_gvar_cache (gvar_cache);
     glyf.release_scratch (scratch);
@@ -551,7 +777,7 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
   /* has_nonzero_coords. */
 
   ot_font->check_serial (font);
-  hb_ot_font_advance_cache_t *advance_cache = ot_font->v.acquire_advance_cache ();
+  hb_ot_font_advance_cache_t *advance_cache = ot_font->v.acquire_advance_cache (font->glyph_cache_bits ());
   if (!advance_cache)
   {
     // malloc failure. Just use the fallback non-variable path.
@@ -565,6 +791,7 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
     const OT::ItemVariationStore &varStore = &VVAR + VVAR.varStore;
     OT::hb_scalar_cache_t *varStore_cache = ot_font->v.acquire_varStore_cache (varStore);
 
+    unsigned misses = 0;
     for (unsigned int i = 0; i < count; i++)
     {
       hb_position_t v;
@@ -574,12 +801,14 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
       else
       {
         v = vmtx.get_advance_with_var_unscaled (*first_glyph, font, varStore_cache);
+	misses++;
 	advance_cache->set (*first_glyph, v);
       }
       *first_advance = font->em_scale_y (- (int) v);
       first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
       first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
     }
+    font->count_advance_cache_lookups (count, misses);
 
     ot_font->v.release_varStore_cache (varStore_cache);
     ot_font->v.release_advance_cache (advance_cache);
@@ -598,6 +827,7 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
     }
     OT::hb_scalar_cache_t *gvar_cache = ot_font->draw.acquire_gvar_cache (gvar);
 
+    unsigned misses = 0;
     for (unsigned int i = 0; i < count; i++)
     {
       hb_position_t v;
@@ -607,12 +837,14 @@ hb_ot_get_glyph_v_advances (hb_font_t* font, void* font_data,
       else
       {
         v = glyf.get_advance_with_var_unscaled (*first_glyph, font, true, *scratch, gvar_cache);
+	misses++;
 	advance_cache->set (*first_glyph, v);
       }
       *first_advance = font->em_scale_y (- (int) v);
       first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
       first_advance = &StructAtOffsetUnaligned<hb_position_t> (first_advance, advance_stride);
     }
+    font->count_advance_cache_lookups (count, misses);
 
     ot_font->draw.release_gvar_cache (gvar_cache);
     glyf.release_scratch (scratch);
@@ -799,35 +1031,128 @@ hb_ot_get_glyph_v_origins (hb_font_t *font,
 }
 #endif
 
-static hb_bool_t
-hb_ot_get_glyph_extents (hb_font_t *font,
-			 void *font_data,
-			 hb_codepoint_t glyph,
-			 hb_glyph_extents_t *extents,
-			 void *user_data HB_UNUSED)
+/* Whether extents come straight from glyf, with nothing else that
+ * would take precedence. */
+static inline bool
+_hb_ot_has_glyf_extents_only (const hb_ot_face_t *ot_face)
 {
-  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
-  const hb_ot_face_t *ot_face = ot_font->ot_face;
+  return (ot_face->get_glyph_sources () & ~hb_ot_face_t::GLYPH_SOURCE_SVG) ==
+	 (hb_ot_face_t::GLYPH_SOURCE_RESOLVED | hb_ot_face_t::GLYPH_SOURCE_glyf);
+}
+
+static HB_ALWAYS_INLINE bool
+_hb_ot_get_glyph_extents (hb_font_t *font,
+			  const hb_ot_face_t *ot_face,
+			  hb_codepoint_t glyph,
+			  hb_glyph_extents_t *extents)
+{
+  unsigned sources = ot_face->get_glyph_sources ();
 
 #if !defined(HB_NO_OT_FONT_BITMAP) && !defined(HB_NO_COLOR)
-  if (ot_face->sbix->get_extents (font, glyph, extents)) return true;
-  if (ot_face->CBDT->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_sbix) &&
+      ot_face->sbix->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_CBDT) &&
+      ot_face->CBDT->get_extents (font, glyph, extents)) return true;
 #endif
 #if !defined(HB_NO_COLOR) && !defined(HB_NO_PAINT)
-  if (ot_face->COLR->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_COLR) &&
+      ot_face->COLR->get_extents (font, glyph, extents)) return true;
 #endif
 #ifndef HB_NO_VAR_COMPOSITES
-  if (ot_face->VARC->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_VARC) &&
+      ot_face->VARC->get_extents (font, glyph, extents)) return true;
 #endif
-  if (ot_face->glyf->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_glyf) &&
+      ot_face->glyf->get_extents (font, glyph, extents)) return true;
 #ifndef HB_NO_OT_FONT_CFF
-  if (ot_face->cff2->get_extents (font, glyph, extents)) return true;
-  if (ot_face->cff1->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_cff2) &&
+      ot_face->cff2->get_extents (font, glyph, extents)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_cff1) &&
+      ot_face->cff1->get_extents (font, glyph, extents)) return true;
 #endif
 
   return false;
 }
 
+static hb_bool_t
+hb_ot_get_glyph_extents (hb_font_t *font,
+			 void *font_data,
+			 hb_codepoint_t glyph,
+			 hb_glyph_extents_t *extents,
+			 void *user_data HB_UNUSED)
+{
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
+
+  /* Without variations, glyf extents are read straight off the glyph
+   * header, which is cheaper than going through the cache. */
+  if (!font->has_nonzero_coords && _hb_ot_has_glyf_extents_only (ot_face))
+    return ot_face->glyf->get_extents (font, glyph, extents);
+
+  ot_font->check_serial (font);
+  hb_ot_font_extents_cache_t *extents_cache = ot_font->extents.acquire_extents_cache ();
+  if (extents_cache && extents_cache->get (glyph, extents))
+  {
+    ot_font->extents.release_extents_cache (extents_cache);
+    return true;
+  }
+
+  bool ret = _hb_ot_get_glyph_extents (font, ot_face, glyph, extents);
+
+  if (ret && extents_cache)
+    extents_cache->set (glyph, *extents);
+  ot_font->extents.release_extents_cache (extents_cache);
+  return ret;
+}
+
+static hb_bool_t
+hb_ot_get_glyph_extents_batch (hb_font_t *font,
+			       void *font_data,
+			       unsigned int count,
+			       const hb_codepoint_t *first_glyph,
+			       unsigned glyph_stride,
+			       hb_glyph_extents_t *first_extents,
+			       unsigned extents_stride,
+			       void *user_data HB_UNUSED)
+{
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  const hb_ot_face_t *ot_face = ot_font->ot_face;
+  bool ret = true;
+
+  bool use_cache = font->has_nonzero_coords || !_hb_ot_has_glyf_extents_only (ot_face);
+  hb_ot_font_extents_cache_t *extents_cache = nullptr;
+  if (use_cache)
+  {
+    ot_font->check_serial (font);
+    extents_cache = ot_font->extents.acquire_extents_cache ();
+  }
+
+  for (unsigned int i = 0; i < count; i++)
+  {
+    hb_codepoint_t glyph = *first_glyph;
+
+    if (!extents_cache || !extents_cache->get (glyph, first_extents))
+    {
+      if (_hb_ot_get_glyph_extents (font, ot_face, glyph, first_extents))
+      {
+	if (extents_cache)
+	  extents_cache->set (glyph, *first_extents);
+      }
+      else
+      {
+	hb_memset (first_extents, 0, sizeof (*first_extents));
+	ret = false;
+      }
+    }
+
+    first_glyph = &StructAtOffsetUnaligned<hb_codepoint_t> (first_glyph, glyph_stride);
+    first_extents = &StructAtOffsetUnaligned<hb_glyph_extents_t> (first_extents, extents_stride);
+  }
+
+  ot_font->extents.release_extents_cache (extents_cache);
+  return ret;
+}
+
 #ifndef HB_NO_OT_FONT_GLYPH_NAMES
 static hb_bool_t
 hb_ot_get_glyph_name (hb_font_t *font HB_UNUSED,
@@ -897,6 +1222,7 @@ hb_ot_draw_glyph_or_fail (hb_font_t *font,
 {
   const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
   hb_draw_session_t draw_session {draw_funcs, draw_data};
+  unsigned sources = ot_font->ot_face->get_glyph_sources ();
   bool ret = false;
 
   OT::hb_scalar_cache_t *gvar_cache = nullptr;
@@ -907,14 +1233,18 @@ hb_ot_draw_glyph_or_fail (hb_font_t *font,
   }
 
 #ifndef HB_NO_VAR_COMPOSITES
-  if (font->face->table.VARC->get_path (font, glyph, draw_session)) { ret = true; goto done; }
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_VARC) &&
+      font->face->table.VARC->get_path (font, glyph, draw_session)) { ret = true; goto done; }
 #endif
   // Keep the following in synch with VARC::get_path_at()
-  if (font->face->table.glyf->get_path (font, glyph, draw_session, gvar_cache)) { ret = true; goto done; }
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_glyf) &&
+      font->face->table.glyf->get_path (font, glyph, draw_session, gvar_cache)) { ret = true; goto done; }
 
 #ifndef HB_NO_CFF
-  if (font->face->table.cff2->get_path (font, glyph, draw_session)) { ret = true; goto done; }
-  if (font->face->table.cff1->get_path (font, glyph, draw_session)) { ret = true; goto done; }
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_cff2) &&
+      font->face->table.cff2->get_path (font, glyph, draw_session)) { ret = true; goto done; }
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_cff1) &&
+      font->face->table.cff1->get_path (font, glyph, draw_session)) { ret = true; goto done; }
 #endif
 
 done:
@@ -936,11 +1266,18 @@ hb_ot_paint_glyph_or_fail (hb_font_t *font,
 			   void *user_data)
 {
 #ifndef HB_NO_COLOR
-  if (font->face->table.COLR->paint_glyph (font, glyph, paint_funcs, paint_data, palette, foreground)) return true;
-  if (font->face->table.SVG->paint_glyph (font, glyph, paint_funcs, paint_data)) return true;
+  const hb_ot_font_t *ot_font = (const hb_ot_font_t *) font_data;
+  unsigned sources = ot_font->ot_face->get_glyph_sources ();
+
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_COLR) &&
+      font->face->table.COLR->paint_glyph (font, glyph, paint_funcs, paint_data, palette, foreground)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_SVG) &&
+      font->face->table.SVG->paint_glyph (font, glyph, paint_funcs, paint_data)) return true;
 #ifndef HB_NO_OT_FONT_BITMAP
-  if (font->face->table.CBDT->paint_glyph (font, glyph, paint_funcs, paint_data)) return true;
-  if (font->face->table.sbix->paint_glyph (font, glyph, paint_funcs, paint_data)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_CBDT) &&
+      font->face->table.CBDT->paint_glyph (font, glyph, paint_funcs, paint_data)) return true;
+  if ((sources & hb_ot_face_t::GLYPH_SOURCE_sbix) &&
+      font->face->table.sbix->paint_glyph (font, glyph, paint_funcs, paint_data)) return true;
 #endif
 #endif
   return false;
@@ -977,6 +1314,7 @@ static struct hb_ot_font_funcs_lazy_loader_t : hb_font_funcs_lazy_loader_t<hb_ot
 #endif
 
     hb_font_funcs_set_glyph_extents_func (funcs, hb_ot_get_glyph_extents, nullptr, nullptr);
+    hb_font_funcs_set_glyph_extents_batch_func (funcs, hb_ot_get_glyph_extents_batch, nullptr, nullptr);
     //hb_font_funcs_set_glyph_contour_point_func (funcs, hb_ot_get_glyph_contour_point, nullptr, nullptr);
 
 #ifndef HB_NO_OT_FONT_GLYPH_NAMES
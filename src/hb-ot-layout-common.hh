@@ -1765,7 +1765,7 @@ struct ClassDefFormat2_4
   private:
   unsigned int get_class (hb_codepoint_t glyph_id) const
   {
-    return rangeRecord.bsearch (glyph_id).value;
+    return rangeRecord.as_array ().bsearch_branchless (glyph_id, &Null (RangeRecord<Types>))->value;
   }
 
   unsigned get_population () const
@@ -2680,6 +2680,22 @@ struct VarRegionList
     return v;
   }
 
+  /* Adds the coordinates on an axis at which the scalars of the regions
+   * change slope: their starts, peaks and ends. */
+  void collect_axis_coords (unsigned axis_index,
+			    hb_vector_t<int> &coords /* OUT */) const
+  {
+    if (axis_index >= axisCount) return;
+    for (unsigned r = 0; r < regionCount; r++)
+    {
+      const VarRegionAxis &axis = axesZ[r * axisCount + axis_index];
+      if (!axis.peakCoord.to_int ()) continue;
+      coords.push (axis.startCoord.to_int ());
+      coords.push (axis.peakCoord.to_int ());
+      coords.push (axis.endCoord.to_int ());
+    }
+  }
+
   bool sanitize (hb_sanitize_context_t *c) const
   {
     TRACE_SANITIZE (this);
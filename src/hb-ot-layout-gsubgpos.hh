@@ -715,6 +715,9 @@ struct hb_ot_apply_context_t :
   const hb_ot_layout_lookup_accelerator_t *lookup_accel = nullptr;
   const ItemVariationStore &var_store;
   hb_scalar_cache_t *var_store_cache;
+  /* Digest of all the current glyphs in the buffer (plus some past glyphs).
+   * Seeded by collect_digest () and kept up to date by add_to_digest ()
+   * as glyphs are replaced, so lookups can be skipped without a rescan. */
   hb_set_digest_t digest;
 
   hb_direction_t direction;
@@ -764,10 +767,19 @@ struct hb_ot_apply_context_t :
 			has_glyph_classes (gdef.has_glyph_classes ())
   {
     init_iters ();
-    buffer->collect_codepoints (digest);
+    collect_digest ();
     match_positions.set_storage (stack_match_positions);
   }
 
+  void collect_digest () { buffer->collect_codepoints (digest); }
+
+  void add_to_digest (hb_codepoint_t glyph_index) { digest.add (glyph_index); }
+
+  /* Whether a lookup with digest @lookup_digest may apply to any glyph
+   * in the buffer. */
+  bool may_intersect (const hb_set_digest_t &lookup_digest) const
+  { return lookup_digest.may_intersect (digest); }
+
   void init_iters ()
   {
     iter_input.init (this, false);
@@ -837,7 +849,7 @@ struct hb_ot_apply_context_t :
 			  bool ligature = false,
 			  bool component = false)
   {
-    digest.add (glyph_index);
+    add_to_digest (glyph_index);
 
     if (new_syllables != (unsigned) -1)
       buffer->cur().syllable() = new_syllables;
@@ -952,6 +964,7 @@ struct hb_accelerate_subtables_context_t :
   {
     friend struct hb_accelerate_subtables_context_t;
     friend struct hb_ot_layout_lookup_accelerator_t;
+    friend struct hb_ot_layout_subtable_index_t;
 
     template <typename T>
     void init (const T &obj_,
@@ -970,8 +983,9 @@ struct hb_accelerate_subtables_context_t :
       cache_func = cache_func_;
       external_cache = external_cache_;
 #endif
+      coverage = &obj_.get_coverage ();
       digest.init ();
-      obj_.get_coverage ().collect_coverage (&digest);
+      coverage->collect_coverage (&digest);
     }
 
 #ifdef HB_NO_OT_LAYOUT_LOOKUP_CACHE
@@ -1001,6 +1015,7 @@ struct hb_accelerate_subtables_context_t :
 
     private:
     const void *obj;
+    const Coverage *coverage;
     hb_apply_func_t apply_func;
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
     hb_apply_func_t apply_cached_func;
@@ -4361,6 +4376,95 @@ struct Extension
  * GSUB/GPOS Common
  */
 
+/* Maps each glyph to the first subtable of a lookup whose coverage
+ * contains it.  Subtables before that one cannot apply to the glyph,
+ * so lookups with many subtables can skip straight to it.  Two-level
+ * table with pages of 256 glyphs; the Null object maps every glyph
+ * to subtable 0, ie. skips nothing. */
+struct hb_ot_layout_subtable_index_t
+{
+  static constexpr unsigned PAGE_BITS = 8;
+  static constexpr unsigned PAGE_SIZE = 1u << PAGE_BITS;
+
+  static hb_ot_layout_subtable_index_t *
+  create (const hb_accelerate_subtables_context_t::hb_applicable_t *subtables,
+	  unsigned count)
+  {
+    if (unlikely (count >= 0xFFFFu))
+      return nullptr;
+
+    auto *index = (hb_ot_layout_subtable_index_t *) hb_calloc (1, sizeof (hb_ot_layout_subtable_index_t));
+    if (unlikely (!index))
+      return nullptr;
+    index->none = count;
+
+    /* Walk backwards so earlier subtables win. */
+    for (unsigned i = count; i; i--)
+    {
+      const Coverage *coverage = subtables[i - 1].coverage;
+      if (!coverage) continue;
+      for (hb_codepoint_t g : coverage->iter ())
+	if (unlikely (!index->set (g, i - 1)))
+	{
+	  index->destroy ();
+	  return nullptr;
+	}
+    }
+
+    DEBUG_MSG (APPLY, nullptr, "subtable index for %u subtables: %u bytes",
+	       count, index->get_size ());
+    return index;
+  }
+
+  void destroy ()
+  {
+    pages.fini ();
+    firsts.fini ();
+    hb_free (this);
+  }
+
+  unsigned get (hb_codepoint_t g) const
+  {
+    unsigned major = g >> PAGE_BITS;
+    if (major >= pages.length) return none;
+    unsigned page = pages.arrayZ[major];
+    if (!page) return none;
+    return firsts.arrayZ[(page - 1) * PAGE_SIZE + (g & (PAGE_SIZE - 1))];
+  }
+
+  unsigned get_size () const
+  { return pages.get_size () + firsts.get_size (); }
+
+  private:
+  bool set (hb_codepoint_t g, unsigned subtable_index)
+  {
+    unsigned major = g >> PAGE_BITS;
+    if (major >= pages.length)
+    {
+      if (unlikely (!pages.resize (major + 1)))
+	return false;
+    }
+    if (!pages.arrayZ[major])
+    {
+      unsigned page = firsts.length / PAGE_SIZE;
+      if (unlikely (page >= 0xFFFFu ||
+		    (firsts.length + PAGE_SIZE) * sizeof (firsts[0]) +
+		    pages.length * sizeof (pages[0]) > HB_OT_LAYOUT_SUBTABLE_INDEX_MAX_SIZE ||
+		    !firsts.resize (firsts.length + PAGE_SIZE, false)))
+	return false;
+      for (unsigned i = 0; i < PAGE_SIZE; i++)
+	firsts.arrayZ[page * PAGE_SIZE + i] = none;
+      pages.arrayZ[major] = page + 1;
+    }
+    firsts.arrayZ[(pages.arrayZ[major] - 1) * PAGE_SIZE + (g & (PAGE_SIZE - 1))] = subtable_index;
+    return true;
+  }
+
+  unsigned none; /* Returned for glyphs no subtable covers; the subtable count. */
+  hb_vector_t<uint16_t> pages; /* Page number plus one, per 256 glyphs; zero if no page. */
+  hb_vector_t<uint16_t> firsts;
+};
+
 struct hb_ot_layout_lookup_accelerator_t
 {
   template <typename TLookup>
@@ -4407,8 +4511,62 @@ struct hb_ot_layout_lookup_accelerator_t
     for (unsigned i = 0; i < count; i++)
       hb_free (subtables[i].external_cache);
 #endif
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+    auto *index = subtable_index.get_relaxed ();
+    if (index && index != &Null (hb_ot_layout_subtable_index_t))
+      index->destroy ();
+#endif
+  }
+
+  /* Index of the first subtable that may apply to glyph @g. */
+  unsigned get_first_subtable (hb_codepoint_t g) const
+  {
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+    if (count >= HB_OT_LAYOUT_SUBTABLE_INDEX_MIN_SUBTABLES)
+      return get_subtable_index ()->get (g);
+#endif
+    return 0;
+  }
+
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+  /* Built on first use; if building fails or the index would be larger
+   * than HB_OT_LAYOUT_SUBTABLE_INDEX_MAX_SIZE, the Null index is stored
+   * instead, which makes every subtable be tried in turn. */
+  const hb_ot_layout_subtable_index_t *get_subtable_index () const
+  {
+  retry:
+    auto *index = subtable_index.get_acquire ();
+    if (likely (index))
+      return index;
+
+    index = hb_ot_layout_subtable_index_t::create (subtables, count);
+    if (unlikely (!index))
+      index = const_cast<hb_ot_layout_subtable_index_t *> (&Null (hb_ot_layout_subtable_index_t));
+
+    if (unlikely (!subtable_index.cmpexch (nullptr, index)))
+    {
+      if (index != &Null (hb_ot_layout_subtable_index_t))
+	index->destroy ();
+      goto retry;
+    }
+    return index;
   }
 
+  /* Builds what get_first_subtable() would otherwise build on first use. */
+  void warm () const
+  {
+    if (count >= HB_OT_LAYOUT_SUBTABLE_INDEX_MIN_SUBTABLES)
+      get_subtable_index ();
+  }
+
+  /* Memory used by the subtable index, if built. */
+  unsigned get_subtable_index_size () const
+  {
+    auto *index = subtable_index.get_acquire ();
+    return index && index != &Null (hb_ot_layout_subtable_index_t) ? index->get_size () : 0;
+  }
+#endif
+
   bool may_have (hb_codepoint_t g) const
   { return digest.may_have (g); }
 
@@ -4418,11 +4576,13 @@ struct hb_ot_layout_lookup_accelerator_t
   bool apply (hb_ot_apply_context_t *c, bool use_cache) const
   {
     c->lookup_accel = this;
+    unsigned first = get_first_subtable (c->buffer->cur().codepoint);
+    if (unlikely (first >= count)) return false;
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
     if (use_cache)
     {
       return
-      + hb_iter (hb_iter (subtables, count))
+      + hb_iter (hb_iter (subtables + first, count - first))
       | hb_map ([&c] (const hb_accelerate_subtables_context_t::hb_applicable_t &_) { return _.apply_cached (c); })
       | hb_any
       ;
@@ -4431,7 +4591,7 @@ struct hb_ot_layout_lookup_accelerator_t
 #endif
     {
       return
-      + hb_iter (hb_iter (subtables, count))
+      + hb_iter (hb_iter (subtables + first, count - first))
       | hb_map ([&c] (const hb_accelerate_subtables_context_t::hb_applicable_t &_) { return _.apply (c); })
       | hb_any
       ;
@@ -4461,6 +4621,9 @@ struct hb_ot_layout_lookup_accelerator_t
   unsigned count = 0; /* Number of subtables in the array. */
 #ifndef HB_NO_OT_LAYOUT_LOOKUP_CACHE
   unsigned subtable_cache_user_idx = (unsigned) -1;
+#endif
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+  mutable hb_atomic_t<hb_ot_layout_subtable_index_t *> subtable_index;
 #endif
   hb_accelerate_subtables_context_t::hb_applicable_t subtables[HB_VAR_ARRAY];
 };
@@ -4881,6 +5044,29 @@ struct GSUBGPOS
       return accel;
     }
 
+    /* Builds the accelerator for a lookup, and everything it would
+     * otherwise build lazily, ahead of its first use. */
+    void warm_lookup (unsigned lookup_index) const
+    {
+      auto *accel = get_accel (lookup_index);
+      if (unlikely (!accel)) return;
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+      accel->warm ();
+#endif
+    }
+
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+    /* Memory used by the subtable indices built so far. */
+    unsigned get_subtable_index_size () const
+    {
+      unsigned size = 0;
+      for (unsigned i = 0; i < lookup_count; i++)
+	if (auto *accel = accels[i].get_acquire ())
+	  size += accel->get_subtable_index_size ();
+      return size;
+    }
+#endif
+
     hb_blob_ptr_t<T> table;
     unsigned int lookup_count;
     hb_atomic_t<hb_ot_layout_lookup_accelerator_t *> *accels;
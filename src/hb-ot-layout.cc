@@ -38,6 +38,7 @@
 
 #include "hb-open-type.hh"
 #include "hb-ot-layout.hh"
+#include "hb-executor.hh"
 #include "hb-ot-face.hh"
 #include "hb-ot-map.hh"
 #include "hb-map.hh"
@@ -1084,6 +1085,36 @@ hb_ot_layout_table_get_lookup_count (hb_face_t    *face,
   return get_gsubgpos_table (face, table_tag).get_lookup_count ();
 }
 
+/**
+ * hb_ot_layout_table_get_subtable_index_size:
+ * @face: #hb_face_t to work upon
+ * @table_tag: #HB_OT_TAG_GSUB or #HB_OT_TAG_GPOS
+ *
+ * Fetches the memory used by the glyph-to-subtable indices built so far
+ * for the lookups of the specified face's GSUB table or GPOS table.
+ *
+ * Lookups with many subtables get such an index, mapping each glyph to
+ * the first subtable that may apply to it, when they are first applied
+ * or when the face is warmed with hb_face_warm().
+ *
+ * Return value: The size of the indices in bytes.
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_ot_layout_table_get_subtable_index_size (hb_face_t    *face,
+					    hb_tag_t      table_tag)
+{
+#ifndef HB_NO_OT_LAYOUT_SUBTABLE_INDEX
+  switch (table_tag)
+  {
+    case HB_OT_TAG_GSUB: return face->table.GSUB->get_subtable_index_size ();
+    case HB_OT_TAG_GPOS: return face->table.GPOS->get_subtable_index_size ();
+  }
+#endif
+  return 0;
+}
+
 
 struct hb_collect_features_context_t
 {
@@ -1504,6 +1535,57 @@ hb_ot_layout_feature_with_variations_get_lookups (hb_face_t    *face,
 }
 
 
+struct hb_ot_layout_warm_lookups_task_t
+{
+  const OT::GSUB_accelerator_t *gsub;
+  const OT::GPOS_accelerator_t *gpos;
+  hb_array_t<const unsigned> gsub_lookups;
+  hb_array_t<const unsigned> gpos_lookups;
+
+  static void run (void *data, unsigned i)
+  {
+    auto *task = (const hb_ot_layout_warm_lookups_task_t *) data;
+    if (i < task->gsub_lookups.length)
+      task->gsub->warm_lookup (task->gsub_lookups.arrayZ[i]);
+    else if ((i -= task->gsub_lookups.length) < task->gpos_lookups.length)
+      task->gpos->warm_lookup (task->gpos_lookups.arrayZ[i]);
+  }
+};
+
+/*
+ * Builds the accelerators of the given GSUB and GPOS lookups, or of all
+ * lookups if the set is nullptr, through @executor, one task per lookup.
+ */
+void
+hb_ot_layout_warm_lookups (hb_face_t      *face,
+			   const hb_set_t *gsub_lookups,
+			   const hb_set_t *gpos_lookups,
+			   hb_executor_t  *executor)
+{
+  const auto *gsub = face->table.GSUB.get ();
+  const auto *gpos = face->table.GPOS.get ();
+
+  hb_vector_t<unsigned> gsub_indexes;
+  hb_vector_t<unsigned> gpos_indexes;
+  if (gsub_lookups)
+    gsub_indexes.extend (*gsub_lookups);
+  else
+    gsub_indexes.extend (hb_range (gsub->lookup_count));
+  if (gpos_lookups)
+    gpos_indexes.extend (*gpos_lookups);
+  else
+    gpos_indexes.extend (hb_range (gpos->lookup_count));
+  if (unlikely (gsub_indexes.in_error () || gpos_indexes.in_error ()))
+    return;
+
+  hb_ot_layout_warm_lookups_task_t task = {gsub, gpos,
+					   gsub_indexes.as_array (),
+					   gpos_indexes.as_array ()};
+  executor->run (hb_ot_layout_warm_lookups_task_t::run, &task,
+		 gsub_indexes.length + gpos_indexes.length);
+}
+
+
 /*
  * OT::GSUB
  */
@@ -1924,8 +2006,27 @@ apply_forward (OT::hb_ot_apply_context_t *c,
   while (buffer->idx < buffer->len && buffer->successful)
   {
     auto &cur = buffer->cur();
-    if (accel.digest.may_have (cur.codepoint) &&
-	(cur.mask & c->lookup_mask) &&
+    if (!accel.digest.may_have (cur.codepoint))
+    {
+      /* Skip the whole run of glyphs the lookup cannot apply to,
+       * a few glyphs at a time. */
+      unsigned skip = 1;
+      while (buffer->idx + skip < buffer->len)
+      {
+	unsigned count = hb_min (buffer->len - (buffer->idx + skip), 8u);
+	uint64_t candidates = accel.digest.may_have_batch (&buffer->info[buffer->idx + skip].codepoint,
+							   count, sizeof (hb_glyph_info_t));
+	if (candidates)
+	{
+	  skip += hb_ctz (candidates);
+	  break;
+	}
+	skip += count;
+      }
+      (void) buffer->next_glyphs (skip);
+      continue;
+    }
+    if ((cur.mask & c->lookup_mask) &&
 	c->check_glyph_property (&cur, c->lookup_props) &&
         accel.apply (c, use_hot_subtable_cache))
       ret = true;
@@ -2032,7 +2133,7 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
        * (plus some past glyphs).
        *
        * Only try applying the lookup if there is any overlap. */
-      if (accel->digest.may_intersect (c.digest))
+      if (c.may_intersect (accel->digest))
       {
 	c.set_lookup_index (lookup_index);
 	c.set_lookup_mask (lookup.mask, false);
@@ -2058,7 +2159,7 @@ inline void hb_ot_map_t::apply (const Proxy &proxy,
       if (stage->pause_func (plan, font, buffer))
       {
 	/* Refresh working buffer digest since buffer changed. */
-	buffer->collect_codepoints (c.digest);
+	c.collect_digest ();
       }
     }
   }
@@ -97,6 +97,14 @@ HB_MARK_AS_FLAG_T (hb_ot_layout_glyph_props_flags_t);
  */
 
 
+/* Builds lookup accelerators ahead of their first use. */
+HB_INTERNAL void
+hb_ot_layout_warm_lookups (hb_face_t      *face,
+			   const hb_set_t *gsub_lookups,
+			   const hb_set_t *gpos_lookups,
+			   hb_executor_t  *executor);
+
+
 /* Should be called before all the substitute_lookup's are done. */
 HB_INTERNAL void
 hb_ot_layout_substitute_start (hb_font_t    *font,
@@ -170,6 +170,35 @@ struct TupleVariationHeader
     return scalar;
   }
 
+  /* Adds the coordinates on an axis at which the scalar of the tuple
+   * changes slope. */
+  void collect_axis_coords (unsigned axis_index, unsigned axis_count,
+			    const hb_array_t<const F2DOT14> shared_tuples,
+			    hb_vector_t<int> &coords /* OUT */) const
+  {
+    const F2DOT14 *peak_tuple;
+    if (has_peak ())
+      peak_tuple = get_peak_tuple (axis_count);
+    else
+    {
+      unsigned int index = get_index ();
+      if (unlikely ((index + 1) * axis_count > shared_tuples.length))
+	return;
+      peak_tuple = shared_tuples.arrayZ + (axis_count * index);
+    }
+
+    int peak = peak_tuple[axis_index].to_int ();
+    if (!peak) return;
+    coords.push (peak);
+    if (has_intermediate ())
+    {
+      coords.push (get_start_tuple (axis_count)[axis_index].to_int ());
+      coords.push (get_end_tuple (axis_count)[axis_index].to_int ());
+    }
+    else
+      coords.push (0);
+  }
+
   bool           has_peak () const { return tupleIndex & TuppleIndex::EmbeddedPeakTuple; }
   bool   has_intermediate () const { return tupleIndex & TuppleIndex::IntermediateRegion; }
   bool has_private_points () const { return tupleIndex & TuppleIndex::PrivatePointNumbers; }
@@ -29,6 +29,7 @@
 #define HB_OT_VAR_GVAR_TABLE_HH
 
 #include "hb-decycler.hh"
+#include "hb-mutex.hh"
 #include "hb-open-type.hh"
 #include "hb-ot-var-common.hh"
 
@@ -47,10 +48,11 @@ struct hb_glyf_scratch_t
   hb_decycler_t decycler;
 
   // gvar
-  contour_point_vector_t orig_points;
+  hb_vector_t<float> orig_coords;	/* All x coordinates, then all y. */
   hb_vector_t<int> x_deltas;
   hb_vector_t<int> y_deltas;
-  contour_point_vector_t deltas;
+  hb_vector_t<float> deltas;		/* All x deltas, then all y. */
+  hb_vector_t<uint8_t> referenced;
   hb_vector_t<unsigned int> shared_indices;
   hb_vector_t<unsigned int> private_indices;
 };
@@ -600,50 +602,194 @@ struct gvar_GVAR
       table = hb_sanitize_context_t ().reference_table<gvar_GVAR> (face);
       /* If sanitize failed, set glyphCount to 0. */
       glyphCount = table->version.to_int () ? face->get_num_glyphs () : 0;
+
+      /* The cap must at least cover a slot per glyph. */
+      decoded_cache_size = face->gvar_decoded_cache_size;
+      if (decoded_cache_size < glyphCount * sizeof (void *))
+	decoded_cache_size = 0;
+      decoded_cache_used.set_relaxed (0);
+      decoded_glyphs.set_relaxed (nullptr);
     }
-    ~accelerator_t () { table.destroy (); }
+    ~accelerator_t ()
+    {
+      auto *slots = decoded_glyphs.get_relaxed ();
+      if (slots)
+      {
+	for (unsigned i = 0; i < glyphCount; i++)
+	  destroy_decoded_glyph (slots[i].get_relaxed ());
+	hb_free (slots);
+      }
 
-    private:
+      table.destroy ();
+    }
 
-    static float infer_delta (const hb_array_t<contour_point_t> points,
-			      const hb_array_t<contour_point_t> deltas,
-			      unsigned int target, unsigned int prev, unsigned int next,
-			      float contour_point_t::*m)
+    /* Adds in[i] * scalar to out[i].  Done in fixed-size blocks, which
+     * compilers vectorize even at -O2; bit-identical to the scalar loop. */
+    static void add_scaled_deltas (float *out, const int *in,
+				   unsigned count, float scalar)
     {
-      float target_val = points.arrayZ[target].*m;
-      float prev_val = points.arrayZ[prev].*m;
-      float next_val = points.arrayZ[next].*m;
-      float prev_delta =  deltas.arrayZ[prev].*m;
-      float next_delta =  deltas.arrayZ[next].*m;
+#ifndef HB_OPTIMIZE_SIZE
+      for (; count >= 8; count -= 8, out += 8, in += 8)
+	for (unsigned i = 0; i < 8; i++)
+	  out[i] += in[i] * scalar;
+#endif
+      for (unsigned i = 0; i < count; i++)
+	out[i] += in[i] * scalar;
+    }
+
+    /* Infers the deltas of the unreferenced points start..end-1, which lie
+     * between the referenced points prev and next of their contour. */
+    static void infer_deltas (float *deltas, const float *orig,
+			      unsigned start, unsigned end,
+			      unsigned prev, unsigned next)
+    {
+      float prev_val = orig[prev];
+      float next_val = orig[next];
+      float prev_delta = deltas[prev];
+      float next_delta = deltas[next];
 
       if (prev_val == next_val)
-	return (prev_delta == next_delta) ? prev_delta : 0.f;
-      else if (target_val <= hb_min (prev_val, next_val))
-	return (prev_val < next_val) ? prev_delta : next_delta;
-      else if (target_val >= hb_max (prev_val, next_val))
-	return (prev_val > next_val) ? prev_delta : next_delta;
-
-      /* linear interpolation */
-      float r = (target_val - prev_val) / (next_val - prev_val);
-      return prev_delta + r * (next_delta - prev_delta);
+      {
+	float delta = (prev_delta == next_delta) ? prev_delta : 0.f;
+	for (unsigned i = start; i < end; i++)
+	  deltas[i] = delta;
+	return;
+      }
+
+      float min_val = hb_min (prev_val, next_val);
+      float max_val = hb_max (prev_val, next_val);
+      float min_delta = (prev_val < next_val) ? prev_delta : next_delta;
+      float max_delta = (prev_val > next_val) ? prev_delta : next_delta;
+      float val_range = next_val - prev_val;
+      float delta_range = next_delta - prev_delta;
+
+      /* Branch-free, for compilers that vectorize selects. */
+      for (unsigned i = start; i < end; i++)
+      {
+	float val = orig[i];
+	float delta = prev_delta + (val - prev_val) / val_range * delta_range;
+	delta = val <= min_val ? min_delta : delta;
+	delta = val >= max_val ? max_delta : delta;
+	deltas[i] = delta;
+      }
     }
 
+    private:
+
+    /* The unreferenced points start..end-1, whose deltas are inferred from
+     * those of the referenced points prev and next of their contour. */
+    struct iup_run_t
+    {
+      unsigned start, end;
+      unsigned prev, next;
+    };
+
+    /* The variation data of a glyph, decoded once into native arrays, so
+     * that applying it at other coordinates takes just the scalars and
+     * multiply-adds.  See hb_face_set_gvar_decoded_cache_size(). */
+    struct decoded_glyph_t
+    {
+      struct tuple_t
+      {
+	const TupleVariationHeader *header;
+	unsigned num_indices;	/* Zero if the tuple applies to all points. */
+	unsigned indices_start;	/* In indices. */
+	unsigned deltas_start;	/* In deltas; x deltas, then y deltas. */
+	unsigned runs_start;	/* In runs. */
+	unsigned num_runs;
+      };
+
+      unsigned size () const
+      {
+	/* Includes the glyph's slot. */
+	return sizeof (*this) + sizeof (void *) +
+	       tuples.allocated * sizeof (tuples[0]) +
+	       indices.allocated * sizeof (indices[0]) +
+	       deltas.allocated * sizeof (deltas[0]) +
+	       runs.allocated * sizeof (runs[0]);
+      }
+
+      unsigned num_points;
+      hb_vector_t<tuple_t> tuples;
+      hb_vector_t<unsigned> indices;
+      hb_vector_t<int> deltas;
+      hb_vector_t<iup_run_t> runs;
+    };
+
     static unsigned int next_index (unsigned int i, unsigned int start, unsigned int end)
     { return (i >= end) ? start : (i + 1); }
 
-    public:
-    bool apply_deltas_to_points (hb_codepoint_t glyph,
-				 hb_array_t<const int> coords,
-				 const hb_array_t<contour_point_t> points,
-				 hb_glyf_scratch_t &scratch,
-				 hb_scalar_cache_t *gvar_cache = nullptr,
-				 bool phantom_only = false) const
+    /* Calls func on the runs of unreferenced points of each contour; one
+     * or two per gap between referenced points, depending on whether the
+     * gap wraps around. */
+    template <typename Func>
+    static void for_each_iup_run (hb_array_t<const contour_point_t> points,
+				  const uint8_t *referenced,
+				  Func func)
     {
-      if (unlikely (glyph >= glyphCount)) return true;
+      unsigned count = points.length;
+      unsigned start_point = 0;
+      unsigned end_point = 0;
+      while (true)
+      {
+	while (end_point < count && !points.arrayZ[end_point].is_end_point)
+	  end_point++;
+	if (unlikely (end_point == count)) break;
 
-      hb_bytes_t var_data_bytes = table->get_glyph_var_data_bytes (table.get_blob (), glyphCount, glyph);
-      if (!var_data_bytes.as<GlyphVariationData> ()->has_data ()) return true;
+	/* Check the number of unreferenced points in a contour. If no unref points or no ref points, nothing to do. */
+	unsigned unref_count = 0;
+	for (unsigned i = start_point; i < end_point + 1; i++)
+	  unref_count += referenced[i];
+	unref_count = (end_point - start_point + 1) - unref_count;
+
+	unsigned j = start_point;
+	if (unref_count == 0 || unref_count > end_point - start_point)
+	  goto no_more_gaps;
 
+	for (;;)
+	{
+	  /* Locate the next gap of unreferenced points between two referenced points prev and next.
+	   * Note that a gap may wrap around at left (start_point) and/or at right (end_point).
+	   */
+	  unsigned int prev, next, i;
+	  for (;;)
+	  {
+	    i = j;
+	    j = next_index (i, start_point, end_point);
+	    if (referenced[i] && !referenced[j]) break;
+	  }
+	  prev = j = i;
+	  for (;;)
+	  {
+	    i = j;
+	    j = next_index (i, start_point, end_point);
+	    if (!referenced[i] && referenced[j]) break;
+	  }
+	  next = j;
+	  if (prev < next)
+	  {
+	    func (iup_run_t {prev + 1, next, prev, next});
+	    unref_count -= next - prev - 1;
+	  }
+	  else
+	  {
+	    func (iup_run_t {prev + 1, end_point + 1, prev, next});
+	    func (iup_run_t {start_point, next, prev, next});
+	    unref_count -= (end_point - prev) + (next - start_point);
+	  }
+	  if (!unref_count) goto no_more_gaps;
+	}
+      no_more_gaps:
+	start_point = end_point = end_point + 1;
+      }
+    }
+
+    /* Decodes all tuples of a glyph's variation data, for its points. */
+    bool decode_glyph (hb_bytes_t var_data_bytes,
+		       hb_array_t<const contour_point_t> points,
+		       decoded_glyph_t &decoded,
+		       hb_glyf_scratch_t &scratch) const
+    {
       auto &shared_indices = scratch.shared_indices;
       shared_indices.clear ();
 
@@ -651,47 +797,22 @@ struct gvar_GVAR
       if (!GlyphVariationData::get_tuple_iterator (var_data_bytes, table->axisCount,
 						   var_data_bytes.arrayZ,
 						   shared_indices, &iterator))
-	return true; /* so isn't applied at all */
-
-      /* Save original points for inferred delta calculation */
-      auto &orig_points_vec = scratch.orig_points;
-      orig_points_vec.clear (); // Populated lazily
-      auto orig_points = orig_points_vec.as_array ();
+	return false;
 
-      /* flag is used to indicate referenced point */
-      auto &deltas_vec = scratch.deltas;
-      deltas_vec.clear (); // Populated lazily
-      auto deltas = deltas_vec.as_array ();
-
-      unsigned num_coords = table->axisCount;
-      hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * num_coords);
+      unsigned count = points.length;
+      decoded.num_points = count;
 
       auto &private_indices = scratch.private_indices;
       auto &x_deltas = scratch.x_deltas;
       auto &y_deltas = scratch.y_deltas;
 
-      unsigned count = points.length;
-      bool flush = false;
-
       do
       {
-	float scalar = iterator.current_tuple->calculate_scalar (coords, num_coords, shared_tuples,
-								 gvar_cache);
-
-	if (scalar == 0.f) continue;
 	const HBUINT8 *p = iterator.get_serialized_data ();
 	unsigned int length = iterator.current_tuple->get_data_size ();
 	if (unlikely (!iterator.var_data_bytes.check_range (p, length)))
 	  return false;
 
-	if (!deltas)
-	{
-	  if (unlikely (!deltas_vec.resize (count, false))) return false;
-	  deltas = deltas_vec.as_array ();
-	  hb_memset (deltas.arrayZ + (phantom_only ? count - 4 : 0), 0,
-		     (phantom_only ? 4 : count) * sizeof (deltas[0]));
-	}
-
 	const HBUINT8 *end = p + length;
 
 	bool has_private_points = iterator.current_tuple->has_private_points ();
@@ -700,165 +821,316 @@ struct gvar_GVAR
 	  return false;
 	const hb_array_t<unsigned int> &indices = has_private_points ? private_indices : shared_indices;
 
-	bool apply_to_all = (indices.length == 0);
-	unsigned num_deltas = apply_to_all ? points.length : indices.length;
-	unsigned start_deltas = (phantom_only && num_deltas >= 4 ? num_deltas - 4 : 0);
+	unsigned num_deltas = indices.length ? indices.length : count;
 	if (unlikely (!x_deltas.resize (num_deltas, false))) return false;
-	if (unlikely (!GlyphVariationData::decompile_deltas (p, x_deltas, end, false, start_deltas))) return false;
+	if (unlikely (!GlyphVariationData::decompile_deltas (p, x_deltas, end))) return false;
 	if (unlikely (!y_deltas.resize (num_deltas, false))) return false;
-	if (unlikely (!GlyphVariationData::decompile_deltas (p, y_deltas, end, false, start_deltas))) return false;
+	if (unlikely (!GlyphVariationData::decompile_deltas (p, y_deltas, end))) return false;
+
+	typename decoded_glyph_t::tuple_t tuple;
+	tuple.header = iterator.current_tuple;
+	tuple.num_indices = indices.length;
+	tuple.indices_start = decoded.indices.length;
+	tuple.deltas_start = decoded.deltas.length;
+	tuple.runs_start = decoded.runs.length;
+	decoded.indices.extend (indices);
+	decoded.deltas.extend (x_deltas);
+	decoded.deltas.extend (y_deltas);
+
+	if (indices.length)
+	{
+	  if (unlikely (!scratch.referenced.resize (count, false)))
+	    return false;
+	  uint8_t *referenced = scratch.referenced.arrayZ;
+	  hb_memset (referenced, 0, count * sizeof (referenced[0]));
+	  for (unsigned pt_index : indices)
+	    if (likely (pt_index < count))
+	      referenced[pt_index] = 1;
+	  for_each_iup_run (points, referenced,
+			    [&] (const iup_run_t &run) { decoded.runs.push (run); });
+	}
+	tuple.num_runs = decoded.runs.length - tuple.runs_start;
+
+	decoded.tuples.push (tuple);
+      } while (iterator.move_to_next ());
+
+      return !decoded.tuples.in_error () &&
+	     !decoded.indices.in_error () &&
+	     !decoded.deltas.in_error () &&
+	     !decoded.runs.in_error ();
+    }
+
+    static void destroy_decoded_glyph (decoded_glyph_t *decoded)
+    {
+      if (!decoded) return;
+      decoded->~decoded_glyph_t ();
+      hb_free (decoded);
+    }
+
+    /* Returns the decoded variation data of glyph, decoding it if the
+     * cache has room; nullptr if there is no cache, or no room. */
+    const decoded_glyph_t *get_decoded_glyph (hb_codepoint_t glyph,
+					      hb_bytes_t var_data_bytes,
+					      hb_array_t<const contour_point_t> points,
+					      hb_glyf_scratch_t &scratch,
+					      bool phantom_only) const
+    {
+      if (!decoded_cache_size) return nullptr;
+
+      auto *slots = decoded_glyphs.get_acquire ();
+      if (slots)
+      {
+	const decoded_glyph_t *decoded = slots[glyph].get_acquire ();
+	if (decoded)
+	  return decoded->num_points == points.length ? decoded : nullptr;
+      }
+
+      /* Contours, which decoding needs, are not loaded for phantom points. */
+      if (phantom_only ||
+	  decoded_cache_used.get_relaxed () >= decoded_cache_size)
+	return nullptr;
 
+      decoded_glyph_t *decoded = (decoded_glyph_t *) hb_calloc (1, sizeof (decoded_glyph_t));
+      if (unlikely (!decoded))
+	return nullptr;
+      decoded = new (decoded) decoded_glyph_t ();
+      if (unlikely (!decode_glyph (var_data_bytes, points, *decoded, scratch)))
+      {
+	destroy_decoded_glyph (decoded);
+	return nullptr;
+      }
+
+      hb_lock_t lock (decoded_cache_lock);
+
+      unsigned used = decoded_cache_used.get_relaxed ();
+      slots = decoded_glyphs.get_relaxed ();
+      if (!slots)
+      {
+	slots = (hb_atomic_t<decoded_glyph_t *> *) hb_calloc (glyphCount, sizeof (slots[0]));
+	if (unlikely (!slots))
+	{
+	  destroy_decoded_glyph (decoded);
+	  return nullptr;
+	}
+	decoded_glyphs.cmpexch (nullptr, slots);
+	used += glyphCount * sizeof (void *);
+      }
+
+      const decoded_glyph_t *existing = slots[glyph].get_relaxed ();
+      unsigned size = decoded->size ();
+      if (existing || size > decoded_cache_size - used)
+      {
+	/* Decoded by another thread meanwhile; or the cache is full, in
+	 * which case stop decoding. */
+	decoded_cache_used.set_relaxed (existing ? used : decoded_cache_size);
+	destroy_decoded_glyph (decoded);
+	return existing && existing->num_points == points.length ? existing : nullptr;
+      }
+
+      decoded_cache_used.set_relaxed (used + size);
+      slots[glyph].cmpexch (nullptr, decoded);
+      return decoded;
+    }
+
+    public:
+    bool apply_deltas_to_points (hb_codepoint_t glyph,
+				 hb_array_t<const int> coords,
+				 const hb_array_t<contour_point_t> points,
+				 hb_glyf_scratch_t &scratch,
+				 hb_scalar_cache_t *gvar_cache = nullptr,
+				 bool phantom_only = false) const
+    {
+      if (unlikely (glyph >= glyphCount)) return true;
+
+      hb_bytes_t var_data_bytes = table->get_glyph_var_data_bytes (table.get_blob (), glyphCount, glyph);
+      if (!var_data_bytes.as<GlyphVariationData> ()->has_data ()) return true;
+
+      const decoded_glyph_t *decoded = get_decoded_glyph (glyph, var_data_bytes, points,
+							  scratch, phantom_only);
+
+      unsigned count = points.length;
+      unsigned first = phantom_only ? count - 4 : 0;
+
+      /* Original points for inferred delta calculation; populated lazily. */
+      const float *orig_x = nullptr;
+      const float *orig_y = nullptr;
+
+      /* Deltas accumulated per point, and whether each point is referenced,
+       * i.e. has explicit deltas; populated lazily.  Kept as separate arrays,
+       * so the loops over them vectorize. */
+      float *deltas_x = nullptr;
+      float *deltas_y = nullptr;
+      uint8_t *referenced = nullptr;
+      auto clear_deltas = [&] ()
+      {
+	if (phantom_only)
+	{
+	  hb_memset (deltas_x + first, 0, 4 * sizeof (deltas_x[0]));
+	  hb_memset (deltas_y + first, 0, 4 * sizeof (deltas_y[0]));
+	}
+	else
+	  hb_memset (deltas_x, 0, 2 * count * sizeof (deltas_x[0]));
+	hb_memset (referenced + first, 0, (count - first) * sizeof (referenced[0]));
+      };
+
+      unsigned num_coords = table->axisCount;
+      hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * num_coords);
+
+      bool flush = false;
+
+      /* Accumulates the deltas of a tuple, scaled.  Those of a tuple that
+       * does not apply to all points are accumulated on their own, to infer
+       * the deltas of unreferenced points from; over runs, if known. */
+      auto add_tuple_deltas = [&] (float scalar,
+				   hb_array_t<const unsigned> indices,
+				   const int *x_deltas,
+				   const int *y_deltas,
+				   const hb_array_t<const iup_run_t> *runs) -> bool
+      {
+	if (!deltas_x)
+	{
+	  if (unlikely (!scratch.deltas.resize (2 * count, false) ||
+			!scratch.referenced.resize (count, false)))
+	    return false;
+	  deltas_x = scratch.deltas.arrayZ;
+	  deltas_y = scratch.deltas.arrayZ + count;
+	  referenced = scratch.referenced.arrayZ;
+	  clear_deltas ();
+	}
+
+	bool apply_to_all = (indices.length == 0);
 	if (!apply_to_all)
 	{
-	  if (!orig_points && !phantom_only)
+	  if (!orig_x && !phantom_only)
 	  {
-	    orig_points_vec.extend (points);
-	    if (unlikely (orig_points_vec.in_error ())) return false;
-	    orig_points = orig_points_vec.as_array ();
+	    if (unlikely (!scratch.orig_coords.resize (2 * count, false)))
+	      return false;
+	    float *x = scratch.orig_coords.arrayZ;
+	    float *y = x + count;
+	    for (unsigned i = 0; i < count; i++)
+	    {
+	      x[i] = points.arrayZ[i].x;
+	      y[i] = points.arrayZ[i].y;
+	    }
+	    orig_x = x;
+	    orig_y = y;
 	  }
 
 	  if (flush)
 	  {
-	    for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	      points.arrayZ[i].translate (deltas.arrayZ[i]);
+	    for (unsigned int i = first; i < count; i++)
+	      points.arrayZ[i].add_delta (deltas_x[i], deltas_y[i]);
 	    flush = false;
-
 	  }
-	  hb_memset (deltas.arrayZ + (phantom_only ? count - 4 : 0), 0,
-		     (phantom_only ? 4 : count) * sizeof (deltas[0]));
+	  clear_deltas ();
 	}
 
-	if (HB_OPTIMIZE_SIZE_VAL)
+	if (apply_to_all)
 	{
-	  for (unsigned int i = 0; i < num_deltas; i++)
-	  {
-	    unsigned int pt_index;
-	    if (apply_to_all)
-	      pt_index = i;
-	    else
-	    {
-	      pt_index = indices[i];
-	      if (unlikely (pt_index >= deltas.length)) continue;
-	    }
-	    if (phantom_only && pt_index < count - 4) continue;
-	    auto &delta = deltas.arrayZ[pt_index];
-	    delta.flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-	    delta.add_delta (x_deltas.arrayZ[i] * scalar,
-			     y_deltas.arrayZ[i] * scalar);
-	  }
+	  add_scaled_deltas (deltas_x + first, x_deltas + first, count - first, scalar);
+	  add_scaled_deltas (deltas_y + first, y_deltas + first, count - first, scalar);
 	}
 	else
-	{
-	  /* Ouch. Four cases... for optimization. */
-	  if (scalar != 1.0f)
-	  {
-	    if (apply_to_all)
-	      for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	      {
-		auto &delta = deltas.arrayZ[i];
-		delta.add_delta (x_deltas.arrayZ[i] * scalar,
-				 y_deltas.arrayZ[i] * scalar);
-	      }
-	    else
-	      for (unsigned int i = 0; i < num_deltas; i++)
-	      {
-		unsigned int pt_index = indices[i];
-		if (unlikely (pt_index >= deltas.length)) continue;
-		if (phantom_only && pt_index < count - 4) continue;
-		auto &delta = deltas.arrayZ[pt_index];
-		delta.flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-		delta.add_delta (x_deltas.arrayZ[i] * scalar,
-				 y_deltas.arrayZ[i] * scalar);
-	      }
-	  }
-	  else
+	  for (unsigned int i = 0; i < indices.length; i++)
 	  {
-	    if (apply_to_all)
-	      for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	      {
-		auto &delta = deltas.arrayZ[i];
-		delta.add_delta (x_deltas.arrayZ[i],
-				 y_deltas.arrayZ[i]);
-	      }
-	    else
-	      for (unsigned int i = 0; i < num_deltas; i++)
-	      {
-		unsigned int pt_index = indices[i];
-		if (unlikely (pt_index >= deltas.length)) continue;
-		if (phantom_only && pt_index < count - 4) continue;
-		auto &delta = deltas.arrayZ[pt_index];
-		delta.flag = 1;	/* this point is referenced, i.e., explicit deltas specified */
-		delta.add_delta (x_deltas.arrayZ[i],
-				 y_deltas.arrayZ[i]);
-	      }
+	    unsigned int pt_index = indices.arrayZ[i];
+	    if (unlikely (pt_index >= count)) continue;
+	    if (pt_index < first) continue;
+	    referenced[pt_index] = 1;
+	    deltas_x[pt_index] += x_deltas[i] * scalar;
+	    deltas_y[pt_index] += y_deltas[i] * scalar;
 	  }
-	}
 
 	/* infer deltas for unreferenced points */
 	if (!apply_to_all && !phantom_only)
 	{
-	  unsigned start_point = 0;
-	  unsigned end_point = 0;
-	  while (true)
+	  auto infer_run = [&] (const iup_run_t &run)
 	  {
-	    while (end_point < count && !points.arrayZ[end_point].is_end_point)
-	      end_point++;
-	    if (unlikely (end_point == count)) break;
-
-	    /* Check the number of unreferenced points in a contour. If no unref points or no ref points, nothing to do. */
-	    unsigned unref_count = 0;
-	    for (unsigned i = start_point; i < end_point + 1; i++)
-	      unref_count += deltas.arrayZ[i].flag;
-	    unref_count = (end_point - start_point + 1) - unref_count;
+	    infer_deltas (deltas_x, orig_x, run.start, run.end, run.prev, run.next);
+	    infer_deltas (deltas_y, orig_y, run.start, run.end, run.prev, run.next);
+	  };
+	  if (runs)
+	    for (const iup_run_t &run : *runs)
+	      infer_run (run);
+	  else
+	    for_each_iup_run (points, referenced, infer_run);
+	}
 
-	    unsigned j = start_point;
-	    if (unref_count == 0 || unref_count > end_point - start_point)
-	      goto no_more_gaps;
+	flush = true;
+	return true;
+      };
 
-	    for (;;)
-	    {
-	      /* Locate the next gap of unreferenced points between two referenced points prev and next.
-	       * Note that a gap may wrap around at left (start_point) and/or at right (end_point).
-	       */
-	      unsigned int prev, next, i;
-	      for (;;)
-	      {
-		i = j;
-		j = next_index (i, start_point, end_point);
-		if (deltas.arrayZ[i].flag && !deltas.arrayZ[j].flag) break;
-	      }
-	      prev = j = i;
-	      for (;;)
-	      {
-		i = j;
-		j = next_index (i, start_point, end_point);
-		if (!deltas.arrayZ[i].flag && deltas.arrayZ[j].flag) break;
-	      }
-	      next = j;
-	      /* Infer deltas for all unref points in the gap between prev and next */
-	      i = prev;
-	      for (;;)
-	      {
-		i = next_index (i, start_point, end_point);
-		if (i == next) break;
-		deltas.arrayZ[i].x = infer_delta (orig_points, deltas, i, prev, next, &contour_point_t::x);
-		deltas.arrayZ[i].y = infer_delta (orig_points, deltas, i, prev, next, &contour_point_t::y);
-		if (--unref_count == 0) goto no_more_gaps;
-	      }
-	    }
-	  no_more_gaps:
-	    start_point = end_point = end_point + 1;
-	  }
+      if (decoded)
+      {
+	for (const auto &tuple : decoded->tuples)
+	{
+	  float scalar = tuple.header->calculate_scalar (coords, num_coords, shared_tuples,
+							 gvar_cache);
+	  if (scalar == 0.f) continue;
+
+	  unsigned num_deltas = tuple.num_indices ? tuple.num_indices : count;
+	  const int *x_deltas = decoded->deltas.arrayZ + tuple.deltas_start;
+	  hb_array_t<const iup_run_t> runs = decoded->runs.as_array ().sub_array (tuple.runs_start, tuple.num_runs);
+	  if (unlikely (!add_tuple_deltas (scalar,
+					   decoded->indices.as_array ().sub_array (tuple.indices_start, tuple.num_indices),
+					   x_deltas, x_deltas + num_deltas,
+					   std::addressof (runs))))
+	    return false;
 	}
+      }
+      else
+      {
+	auto &shared_indices = scratch.shared_indices;
+	shared_indices.clear ();
 
-	flush = true;
+	typename GlyphVariationData::tuple_iterator_t iterator;
+	if (!GlyphVariationData::get_tuple_iterator (var_data_bytes, table->axisCount,
+						     var_data_bytes.arrayZ,
+						     shared_indices, &iterator))
+	  return true; /* so isn't applied at all */
 
-      } while (iterator.move_to_next ());
+	auto &private_indices = scratch.private_indices;
+	auto &x_deltas = scratch.x_deltas;
+	auto &y_deltas = scratch.y_deltas;
+
+	do
+	{
+	  float scalar = iterator.current_tuple->calculate_scalar (coords, num_coords, shared_tuples,
+								   gvar_cache);
+
+	  if (scalar == 0.f) continue;
+	  const HBUINT8 *p = iterator.get_serialized_data ();
+	  unsigned int length = iterator.current_tuple->get_data_size ();
+	  if (unlikely (!iterator.var_data_bytes.check_range (p, length)))
+	    return false;
+
+	  const HBUINT8 *end = p + length;
+
+	  bool has_private_points = iterator.current_tuple->has_private_points ();
+	  if (has_private_points &&
+	      !GlyphVariationData::decompile_points (p, private_indices, end))
+	    return false;
+	  const hb_array_t<unsigned int> &indices = has_private_points ? private_indices : shared_indices;
+
+	  bool apply_to_all = (indices.length == 0);
+	  unsigned num_deltas = apply_to_all ? points.length : indices.length;
+	  unsigned start_deltas = (phantom_only && num_deltas >= 4 ? num_deltas - 4 : 0);
+	  if (unlikely (!x_deltas.resize (num_deltas, false))) return false;
+	  if (unlikely (!GlyphVariationData::decompile_deltas (p, x_deltas, end, false, start_deltas))) return false;
+	  if (unlikely (!y_deltas.resize (num_deltas, false))) return false;
+	  if (unlikely (!GlyphVariationData::decompile_deltas (p, y_deltas, end, false, start_deltas))) return false;
+
+	  if (unlikely (!add_tuple_deltas (scalar, indices,
+					   x_deltas.arrayZ, y_deltas.arrayZ,
+					   nullptr)))
+	    return false;
+	} while (iterator.move_to_next ());
+      }
 
       if (flush)
       {
-	for (unsigned int i = phantom_only ? count - 4 : 0; i < count; i++)
-	  points.arrayZ[i].translate (deltas.arrayZ[i]);
+	for (unsigned int i = first; i < count; i++)
+	  points.arrayZ[i].add_delta (deltas_x[i], deltas_y[i]);
       }
 
       return true;
@@ -866,9 +1138,40 @@ struct gvar_GVAR
 
     unsigned int get_axis_count () const { return table->axisCount; }
 
+    /* Adds the coordinates on an axis at which the scalars of the tuples
+     * of glyphs change slope. */
+    void collect_axis_coords (unsigned axis_index,
+			      hb_array_t<const hb_codepoint_t> glyphs,
+			      hb_vector_t<int> &coords /* OUT */) const
+    {
+      unsigned axis_count = table->axisCount;
+      if (axis_index >= axis_count) return;
+      hb_array_t<const F2DOT14> shared_tuples = (table+table->sharedTuples).as_array (table->sharedTupleCount * axis_count);
+
+      for (hb_codepoint_t glyph : glyphs)
+      {
+	if (unlikely (glyph >= glyphCount)) continue;
+	hb_bytes_t var_data_bytes = table->get_glyph_var_data_bytes (table.get_blob (), glyphCount, glyph);
+	if (!var_data_bytes.as<GlyphVariationData> ()->has_data ()) continue;
+
+	typename GlyphVariationData::tuple_iterator_t iterator;
+	iterator.init (var_data_bytes, axis_count, var_data_bytes.arrayZ);
+	if (!iterator.is_valid ()) continue;
+	do
+	  iterator.current_tuple->collect_axis_coords (axis_index, axis_count, shared_tuples, coords);
+	while (iterator.move_to_next ());
+      }
+    }
+
     private:
     hb_blob_ptr_t<gvar_GVAR> table;
     unsigned glyphCount;
+
+    /* Decoded glyphs, by glyph; see hb_face_set_gvar_decoded_cache_size(). */
+    unsigned decoded_cache_size;
+    mutable hb_atomic_t<unsigned> decoded_cache_used;
+    mutable hb_atomic_t<hb_atomic_t<decoded_glyph_t *> *> decoded_glyphs;
+    mutable hb_mutex_t decoded_cache_lock;
   };
 
   protected:
@@ -144,6 +144,9 @@ struct MVAR
     return (this+varStore).get_delta (record->varIdx, coords, coord_count);
   }
 
+  const ItemVariationStore& get_var_store () const
+  { return this+varStore; }
+
 protected:
   static int tag_compare (const void *pa, const void *pb)
   {
@@ -30,9 +30,17 @@
 
 #include "hb-ot-var.h"
 
+#include "hb-draw.hh"
+#include "hb-font.hh"
+#include "hb-ot-face.hh"
+
+#include "hb-ot-cff2-table.hh"
+#include "hb-ot-hmtx-table.hh"
 #include "hb-ot-var-avar-table.hh"
 #include "hb-ot-var-fvar-table.hh"
+#include "hb-ot-var-gvar-table.hh"
 #include "hb-ot-var-mvar-table.hh"
+#include "hb-ot-var-varc-table.hh"
 
 
 /**
@@ -337,4 +345,651 @@ hb_ot_var_normalize_coords (hb_face_t    *face,
 }
 
 
+
+/*
+ * Blends.
+ */
+
+struct hb_ot_var_blend_t
+{
+  hb_object_header_t header;
+
+  struct outline_t
+  {
+    unsigned verb_start;
+    unsigned verb_count;
+    unsigned point_start;	/* Index into points, which holds X and Y pairs. */
+  };
+
+  bool init (hb_font_t *font, hb_tag_t axis_tag,
+	     float min_value, float max_value,
+	     hb_array_t<const hb_codepoint_t> glyphs);
+
+  /* Returns the sample at or before value, and in t how far value is
+   * towards the next sample; clamped to the sampled range. */
+  unsigned find_sample (float value, float *t) const
+  {
+    unsigned count = values.length;
+    *t = 0.f;
+    if (count < 2 || !(value > values.arrayZ[0]))
+      return 0;
+    if (value >= values.arrayZ[count - 1])
+      return count - 1;
+
+    unsigned lo = 0, hi = count - 1;
+    while (hi - lo > 1)
+    {
+      unsigned mid = (lo + hi) / 2;
+      if (values.arrayZ[mid] <= value)
+	lo = mid;
+      else
+	hi = mid;
+    }
+    *t = (value - values.arrayZ[lo]) / (values.arrayZ[lo + 1] - values.arrayZ[lo]);
+    return lo;
+  }
+
+  hb_position_t get_advance (const hb_vector_t<hb_position_t> &advances,
+			     hb_codepoint_t glyph, float value) const
+  {
+    unsigned *index;
+    if (!glyph_indices.has (glyph, &index))
+      return 0;
+
+    float t;
+    unsigned i = find_sample (value, &t);
+    unsigned j = hb_min (i + 1, values.length - 1);
+    const hb_position_t *a = advances.arrayZ + *index * values.length;
+    return (hb_position_t) _hb_roundf (a[i] + t * (a[j] - a[i]));
+  }
+
+  bool draw_glyph (hb_codepoint_t glyph, float value,
+		   hb_draw_funcs_t *dfuncs, void *draw_data) const
+  {
+#ifndef HB_NO_DRAW
+    unsigned *index;
+    if (!glyph_indices.has (glyph, &index))
+      return false;
+
+    float t;
+    unsigned i = find_sample (value, &t);
+    unsigned j = hb_min (i + 1, values.length - 1);
+    const outline_t &a = outlines.arrayZ[*index * values.length + i];
+    const outline_t &b = outlines.arrayZ[*index * values.length + j];
+
+    /* Outlines only blend if they have the same commands; otherwise
+     * draw the nearer sample. */
+    const outline_t *outline = &a;
+    if (a.verb_start != b.verb_start || a.verb_count != b.verb_count)
+    {
+      if (t >= .5f) outline = &b;
+      t = 0.f;
+    }
+
+    const uint8_t *verb = verbs.arrayZ + outline->verb_start;
+    const float *p = points.arrayZ + 2 * outline->point_start;
+    const float *q = t ? points.arrayZ + 2 * b.point_start : p;
+    float x[3], y[3];
+    auto next_points = [&] (unsigned count)
+    {
+      for (unsigned k = 0; k < count; k++)
+      {
+	x[k] = p[0] + t * (q[0] - p[0]);
+	y[k] = p[1] + t * (q[1] - p[1]);
+	p += 2;
+	q += 2;
+      }
+    };
+
+    hb_draw_session_t draw_session (dfuncs, draw_data);
+    for (unsigned k = 0; k < outline->verb_count; k++)
+      switch (verb[k])
+      {
+      case HB_DRAW_VERB_MOVE_TO:
+	next_points (1);
+	draw_session.move_to (x[0], y[0]);
+	break;
+      case HB_DRAW_VERB_LINE_TO:
+	next_points (1);
+	draw_session.line_to (x[0], y[0]);
+	break;
+      case HB_DRAW_VERB_QUADRATIC_TO:
+	next_points (2);
+	draw_session.quadratic_to (x[0], y[0], x[1], y[1]);
+	break;
+      case HB_DRAW_VERB_CUBIC_TO:
+	next_points (3);
+	draw_session.cubic_to (x[0], y[0], x[1], y[1], x[2], y[2]);
+	break;
+      case HB_DRAW_VERB_CLOSE_PATH:
+	draw_session.close_path ();
+	break;
+      }
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  protected:
+
+  bool draw_outline (hb_font_t *font, hb_codepoint_t glyph, outline_t &outline)
+  {
+#ifndef HB_NO_DRAW
+    outline.verb_start = verbs.length;
+    outline.point_start = points.length / 2;
+    unsigned verb_room = 64, point_room = 128;
+    for (;;)
+    {
+      if (unlikely (!verbs.resize (outline.verb_start + verb_room, false) ||
+		    !points.resize (2 * (outline.point_start + point_room), false)))
+	return false;
+
+      unsigned verb_count = verb_room, point_count = point_room;
+      if (hb_font_draw_glyphs_packed (font, 1, &glyph, 0,
+				      &verb_count, verbs.arrayZ + outline.verb_start,
+				      &point_count, points.arrayZ + 2 * outline.point_start,
+				      nullptr))
+      {
+	outline.verb_count = verb_count;
+	verbs.shrink (outline.verb_start + verb_count, false);
+	points.shrink (2 * (outline.point_start + point_count), false);
+	return true;
+      }
+
+      if (unlikely (verb_room >= HB_GLYF_MAX_POINTS))
+	return false;
+      verb_room *= 2;
+      point_room *= 2;
+    }
+#else
+    outline = {verbs.length, 0, points.length / 2};
+    return true;
+#endif
+  }
+
+  public:
+  hb_vector_t<float> values;	/* The sampled axis values, increasing. */
+  hb_hashmap_t<hb_codepoint_t, unsigned> glyph_indices;
+  /* Per glyph index, then per sample. */
+  hb_vector_t<hb_position_t> h_advances;
+  hb_vector_t<hb_position_t> v_advances;
+  hb_vector_t<outline_t> outlines;
+  hb_vector_t<uint8_t> verbs;
+  hb_vector_t<float> points;
+};
+
+static int
+_hb_cmp_int (const void *pa, const void *pb)
+{ return _hb_cmp_operator<int, int> (pa, pb); }
+
+static void
+_hb_sort_and_dedup (hb_vector_t<int> &coords)
+{
+  coords.qsort (_hb_cmp_int);
+  unsigned count = 0;
+  for (unsigned i = 0; i < coords.length; i++)
+    if (!count || coords.arrayZ[i] != coords.arrayZ[count - 1])
+      coords.arrayZ[count++] = coords.arrayZ[i];
+  coords.shrink (count, false);
+}
+
+static int
+_hb_cmp_float (const void *pa, const void *pb)
+{ return _hb_cmp_operator<float, float> (pa, pb); }
+
+bool
+hb_ot_var_blend_t::init (hb_font_t *font, hb_tag_t axis_tag,
+			 float min_value, float max_value,
+			 hb_array_t<const hb_codepoint_t> glyphs)
+{
+  hb_face_t *face = font->face;
+
+  hb_ot_var_axis_info_t axis;
+  if (!hb_ot_var_find_axis_info (face, axis_tag, &axis))
+    return false;
+  if (min_value > max_value)
+    hb_swap (min_value, max_value);
+  min_value = hb_clamp (min_value, axis.min_value, axis.max_value);
+  max_value = hb_clamp (max_value, axis.min_value, axis.max_value);
+
+  /* The design coordinates of the font; only the blended axis varies. */
+  unsigned axis_count = hb_ot_var_get_axis_count (face);
+  hb_vector_t<float> design_coords;
+  hb_vector_t<hb_ot_var_axis_info_t> axes;
+  if (unlikely (!design_coords.resize (axis_count) ||
+		!axes.resize (axis_count)))
+    return false;
+  hb_ot_var_get_axis_infos (face, 0, &axis_count, axes.arrayZ);
+  unsigned font_coords_length;
+  const float *font_coords = hb_font_get_var_coords_design (font, &font_coords_length);
+  for (unsigned i = 0; i < axis_count; i++)
+  {
+    if (i >= font_coords_length)
+      design_coords.arrayZ[i] = axes.arrayZ[i].default_value;
+    else if (unlikely (std::isnan (font_coords[i])))
+      return false; /* Set as normalized coordinates. */
+    else
+      design_coords.arrayZ[i] = font_coords[i];
+  }
+
+  hb_vector_t<hb_codepoint_t> unique_glyphs;
+  for (hb_codepoint_t glyph : glyphs)
+    if (!glyph_indices.has (glyph))
+    {
+      glyph_indices.set (glyph, unique_glyphs.length);
+      unique_glyphs.push (glyph);
+    }
+  if (unlikely (glyph_indices.in_error () || unique_glyphs.in_error ()))
+    return false;
+
+  /* The normalized coordinates on the axis at which any variation
+   * changes slope.  Between them, advances and outlines are linear
+   * in the normalized coordinate. */
+  unsigned axis_index = axis.axis_index;
+  hb_vector_t<int> coords;
+  coords.push (0);
+  {
+    const OT::SegmentMaps *map = face->table.avar->get_segment_maps ();
+    unsigned count = hb_min (face->table.avar->get_axis_count (), axis_count);
+    if (axis_index < count)
+    {
+      for (unsigned i = 0; i < axis_index; i++)
+	map = &StructAfter<OT::SegmentMaps> (*map);
+      for (const OT::AxisValueMap &value_map : map->as_array ())
+	coords.push (value_map.coords[1].to_int ());
+    }
+  }
+  face->table.hmtx->var_table->get_var_store ().get_region_list ().collect_axis_coords (axis_index, coords);
+#ifndef HB_NO_VERTICAL
+  face->table.vmtx->var_table->get_var_store ().get_region_list ().collect_axis_coords (axis_index, coords);
+#endif
+  face->table.MVAR->get_var_store ().get_region_list ().collect_axis_coords (axis_index, coords);
+#ifndef HB_NO_CFF
+  if (face->table.cff2->varStore)
+    face->table.cff2->varStore->varStore.get_region_list ().collect_axis_coords (axis_index, coords);
+#endif
+  _hb_sort_and_dedup (coords);
+  /* Glyphs tend to share their tuples; keep the list short as we go. */
+  for (unsigned start = 0; start < unique_glyphs.length; start += 256)
+  {
+    hb_array_t<const hb_codepoint_t> batch = unique_glyphs.as_array ().sub_array (start, 256);
+    face->table.gvar->collect_axis_coords (axis_index, batch, coords);
+#ifndef HB_NO_BEYOND_64K
+    face->table.GVAR->collect_axis_coords (axis_index, batch, coords);
+#endif
+    _hb_sort_and_dedup (coords);
+  }
+  if (unlikely (coords.in_error ()))
+    return false;
+
+  /* With avar2, the axis also moves the normalized coordinates of other
+   * axes; that is not piecewise linear, so is sampled uniformly. */
+  bool nonlinear = false;
+#ifndef HB_NO_VAR_COMPOSITES
+  if (face->table.VARC->has_data ())
+    nonlinear = true;
+#endif
+  hb_vector_t<int> normalized, first_normalized;
+  if (unlikely (!normalized.resize (axis_count)))
+    return false;
+  auto normalize = [&] (float value)
+  {
+    design_coords.arrayZ[axis_index] = value;
+    hb_ot_var_normalize_coords (face, axis_count, design_coords.arrayZ, normalized.arrayZ);
+    if (!first_normalized)
+      first_normalized = normalized;
+    else
+      for (unsigned i = 0; i < axis_count; i++)
+	if (i != axis_index && normalized.arrayZ[i] != first_normalized.arrayZ[i])
+	  nonlinear = true;
+    return normalized.arrayZ[axis_index];
+  };
+
+  int min_coord = normalize (min_value);
+  int max_coord = normalize (max_value);
+  values.push (min_value);
+  int last_coord = min_coord;
+  for (int coord : coords)
+  {
+    if (coord <= last_coord || coord >= max_coord)
+      continue;
+    last_coord = coord;
+
+    /* Find the smallest value that normalizes to coord. */
+    float lo = min_value, hi = max_value;
+    for (unsigned i = 0; i < 32; i++)
+    {
+      float mid = lo + (hi - lo) * .5f;
+      if (mid <= lo || mid >= hi)
+	break;
+      if (normalize (mid) >= coord)
+	hi = mid;
+      else
+	lo = mid;
+    }
+    values.push (hi);
+  }
+  if (nonlinear)
+    for (unsigned i = 1; i < HB_OT_VAR_BLEND_NONLINEAR_SAMPLES; i++)
+      values.push (min_value + (max_value - min_value) * i / HB_OT_VAR_BLEND_NONLINEAR_SAMPLES);
+  values.push (max_value);
+  if (unlikely (values.in_error ()))
+    return false;
+
+  values.qsort (_hb_cmp_float);
+  unsigned count = 0;
+  for (unsigned i = 0; i < values.length; i++)
+    if (!count || values.arrayZ[i] != values.arrayZ[count - 1])
+      values.arrayZ[count++] = values.arrayZ[i];
+  values.shrink (count);
+  if (values.length > HB_OT_VAR_BLEND_MAX_SAMPLES)
+  {
+    /* Keep evenly spaced samples, including both ends. */
+    unsigned max_count = HB_OT_VAR_BLEND_MAX_SAMPLES;
+    for (unsigned i = 0; i < max_count; i++)
+      values.arrayZ[i] = values.arrayZ[(uint64_t) i * (count - 1) / (max_count - 1)];
+    values.shrink (max_count);
+  }
+
+  /* Sample. */
+  unsigned num_glyphs = unique_glyphs.length;
+  unsigned num_values = values.length;
+  hb_vector_t<hb_position_t> advances;
+  if (unlikely (!advances.resize (num_glyphs) ||
+		!h_advances.resize (num_glyphs * num_values) ||
+		!v_advances.resize (num_glyphs * num_values) ||
+		!outlines.resize (num_glyphs * num_values)))
+    return false;
+
+  hb_font_t *sample_font = hb_font_create_sub_font (font);
+#ifndef HB_NO_OT_FONT
+  hb_ot_font_set_funcs (sample_font);
+#endif
+  bool ret = true;
+  for (unsigned s = 0; s < num_values && ret; s++)
+  {
+    design_coords.arrayZ[axis_index] = values.arrayZ[s];
+    hb_font_set_var_coords_design (sample_font, design_coords.arrayZ, axis_count);
+
+    hb_font_get_glyph_h_advances (sample_font, num_glyphs,
+				  unique_glyphs.arrayZ, sizeof (hb_codepoint_t),
+				  advances.arrayZ, sizeof (hb_position_t));
+    for (unsigned g = 0; g < num_glyphs; g++)
+      h_advances.arrayZ[g * num_values + s] = advances.arrayZ[g];
+    hb_font_get_glyph_v_advances (sample_font, num_glyphs,
+				  unique_glyphs.arrayZ, sizeof (hb_codepoint_t),
+				  advances.arrayZ, sizeof (hb_position_t));
+    for (unsigned g = 0; g < num_glyphs; g++)
+      v_advances.arrayZ[g * num_values + s] = advances.arrayZ[g];
+
+    for (unsigned g = 0; g < num_glyphs; g++)
+    {
+      outline_t &outline = outlines.arrayZ[g * num_values + s];
+      if (unlikely (!draw_outline (sample_font, unique_glyphs.arrayZ[g], outline)))
+      {
+	ret = false;
+	break;
+      }
+
+      /* Share the commands with the previous sample if they match. */
+      if (s)
+      {
+	const outline_t &prev = outlines.arrayZ[g * num_values + s - 1];
+	if (prev.verb_count == outline.verb_count &&
+	    !hb_memcmp (verbs.arrayZ + prev.verb_start,
+			verbs.arrayZ + outline.verb_start,
+			outline.verb_count))
+	{
+	  verbs.shrink (outline.verb_start, false);
+	  outline.verb_start = prev.verb_start;
+	}
+      }
+    }
+  }
+  hb_font_destroy (sample_font);
+
+  return ret;
+}
+
+
+/**
+ * hb_ot_var_blend_create:
+ * @font: #hb_font_t to sample
+ * @axis_tag: The tag of the variation axis to blend along
+ * @min_value: The smallest design-space value of the axis to blend
+ * @max_value: The largest design-space value of the axis to blend
+ * @glyphs: (array length=glyph_count): The glyphs to sample
+ * @glyph_count: The number of glyphs in @glyphs
+ *
+ * Samples the advances and outlines of @glyphs in @font with the
+ * OpenType font functions, at values of the axis @axis_tag between
+ * @min_value and @max_value, with the other axes set as in @font.
+ * The result can then be queried at any value in that range, for
+ * example every frame of an animation, much faster than setting the
+ * variations on a font and fetching them again.
+ *
+ * The axis is sampled wherever any variation of @glyphs changes
+ * slope, so that between samples the blended advances and outlines
+ * match those of the font up to rounding.  Fonts with variable
+ * composites, or whose `avar` table maps the axis onto other axes,
+ * do not vary linearly between such samples; they are sampled
+ * uniformly too, and the blends approximate them.  The number of
+ * samples is also limited (to 64 by default); if the variations change
+ * slope at more values than that in the range, only an evenly spread
+ * subset of them is sampled, and the blends approximate the font
+ * between those.
+ *
+ * If @font has its variations set as normalized coordinates, or has
+ * no axis @axis_tag, the empty blend is returned.
+ *
+ * Return value: (transfer full): Newly created blend, or the empty blend
+ * on failure; destroy with hb_ot_var_blend_destroy()
+ *
+ * Since: REPLACEME
+ **/
+hb_ot_var_blend_t *
+hb_ot_var_blend_create (hb_font_t            *font,
+			hb_tag_t              axis_tag,
+			float                 min_value,
+			float                 max_value,
+			const hb_codepoint_t *glyphs,
+			unsigned int          glyph_count)
+{
+#ifndef HB_NO_OT_FONT
+  hb_ot_var_blend_t *blend;
+  if (unlikely (!(blend = hb_object_create<hb_ot_var_blend_t> ())))
+    return hb_ot_var_blend_get_empty ();
+
+  if (unlikely (!blend->init (font, axis_tag, min_value, max_value,
+			      hb_array (glyphs, glyph_count))))
+  {
+    hb_ot_var_blend_destroy (blend);
+    return hb_ot_var_blend_get_empty ();
+  }
+
+  return blend;
+#else
+  return hb_ot_var_blend_get_empty ();
+#endif
+}
+
+/**
+ * hb_ot_var_blend_get_empty:
+ *
+ * Fetches the empty blend object.
+ *
+ * Return value: (transfer full): The empty blend
+ *
+ * Since: REPLACEME
+ **/
+hb_ot_var_blend_t *
+hb_ot_var_blend_get_empty ()
+{
+  return const_cast<hb_ot_var_blend_t *> (&Null (hb_ot_var_blend_t));
+}
+
+/**
+ * hb_ot_var_blend_reference: (skip)
+ * @blend: A blend
+ *
+ * Increases the reference count on a blend.
+ *
+ * Return value: (transfer full): The blend
+ *
+ * Since: REPLACEME
+ **/
+hb_ot_var_blend_t *
+hb_ot_var_blend_reference (hb_ot_var_blend_t *blend)
+{
+  return hb_object_reference (blend);
+}
+
+/**
+ * hb_ot_var_blend_destroy: (skip)
+ * @blend: A blend
+ *
+ * Decreases the reference count on a blend. When the reference count
+ * reaches zero, the blend is destroyed, freeing all memory.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_ot_var_blend_destroy (hb_ot_var_blend_t *blend)
+{
+  if (!hb_object_destroy (blend)) return;
+
+  hb_free (blend);
+}
+
+/**
+ * hb_ot_var_blend_set_user_data: (skip)
+ * @blend: A blend
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified blend.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_var_blend_set_user_data (hb_ot_var_blend_t  *blend,
+			       hb_user_data_key_t *key,
+			       void *              data,
+			       hb_destroy_func_t   destroy,
+			       hb_bool_t           replace)
+{
+  return hb_object_set_user_data (blend, key, data, destroy, replace);
+}
+
+/**
+ * hb_ot_var_blend_get_user_data: (skip)
+ * @blend: A blend
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified blend.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: REPLACEME
+ **/
+void *
+hb_ot_var_blend_get_user_data (const hb_ot_var_blend_t *blend,
+			       hb_user_data_key_t      *key)
+{
+  return hb_object_get_user_data (blend, key);
+}
+
+/**
+ * hb_ot_var_blend_get_sample_count:
+ * @blend: A blend
+ *
+ * Fetches the number of axis values at which @blend was sampled.
+ *
+ * Return value: The number of samples
+ *
+ * Since: REPLACEME
+ **/
+unsigned int
+hb_ot_var_blend_get_sample_count (const hb_ot_var_blend_t *blend)
+{
+  return blend->values.length;
+}
+
+/**
+ * hb_ot_var_blend_get_glyph_h_advance:
+ * @blend: A blend
+ * @glyph: The glyph ID to query
+ * @value: The design-space value of the axis
+ *
+ * Fetches the horizontal advance of @glyph at @value of the axis of
+ * @blend.  Values outside the sampled range are clamped to it.
+ *
+ * Return value: The advance, or 0 if @glyph was not sampled
+ *
+ * Since: REPLACEME
+ **/
+hb_position_t
+hb_ot_var_blend_get_glyph_h_advance (const hb_ot_var_blend_t *blend,
+				     hb_codepoint_t           glyph,
+				     float                    value)
+{
+  return blend->get_advance (blend->h_advances, glyph, value);
+}
+
+/**
+ * hb_ot_var_blend_get_glyph_v_advance:
+ * @blend: A blend
+ * @glyph: The glyph ID to query
+ * @value: The design-space value of the axis
+ *
+ * Fetches the vertical advance of @glyph at @value of the axis of
+ * @blend.  Values outside the sampled range are clamped to it.
+ *
+ * Return value: The advance, or 0 if @glyph was not sampled
+ *
+ * Since: REPLACEME
+ **/
+hb_position_t
+hb_ot_var_blend_get_glyph_v_advance (const hb_ot_var_blend_t *blend,
+				     hb_codepoint_t           glyph,
+				     float                    value)
+{
+  return blend->get_advance (blend->v_advances, glyph, value);
+}
+
+/**
+ * hb_ot_var_blend_draw_glyph:
+ * @blend: A blend
+ * @glyph: The glyph ID to draw
+ * @value: The design-space value of the axis
+ * @dfuncs: #hb_draw_funcs_t to draw to
+ * @draw_data: User data to pass to draw callbacks
+ *
+ * Draws the outline of @glyph at @value of the axis of @blend.
+ * Values outside the sampled range are clamped to it.
+ *
+ * Where the outline of @glyph changes its drawing commands between
+ * two samples, the nearer sample is drawn unblended.
+ *
+ * Return value: `true` if @glyph was sampled, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_ot_var_blend_draw_glyph (const hb_ot_var_blend_t *blend,
+			    hb_codepoint_t           glyph,
+			    float                    value,
+			    hb_draw_funcs_t         *dfuncs,
+			    void                    *draw_data)
+{
+  return blend->draw_glyph (glyph, value, dfuncs, draw_data);
+}
+
+
 #endif
@@ -186,6 +186,69 @@ hb_ot_var_normalize_coords (hb_face_t    *face,
 			    int *normalized_coords /* OUT */);
 
 
+/*
+ * Blends.
+ */
+
+/**
+ * hb_ot_var_blend_t:
+ *
+ * Data type for the advances and outlines of a set of glyphs, sampled
+ * along a range of a variation axis, to blend between.
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_ot_var_blend_t hb_ot_var_blend_t;
+
+HB_EXTERN hb_ot_var_blend_t *
+hb_ot_var_blend_create (hb_font_t            *font,
+			hb_tag_t              axis_tag,
+			float                 min_value,
+			float                 max_value,
+			const hb_codepoint_t *glyphs,
+			unsigned int          glyph_count);
+
+HB_EXTERN hb_ot_var_blend_t *
+hb_ot_var_blend_get_empty (void);
+
+HB_EXTERN hb_ot_var_blend_t *
+hb_ot_var_blend_reference (hb_ot_var_blend_t *blend);
+
+HB_EXTERN void
+hb_ot_var_blend_destroy (hb_ot_var_blend_t *blend);
+
+HB_EXTERN hb_bool_t
+hb_ot_var_blend_set_user_data (hb_ot_var_blend_t  *blend,
+			       hb_user_data_key_t *key,
+			       void *              data,
+			       hb_destroy_func_t   destroy,
+			       hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_ot_var_blend_get_user_data (const hb_ot_var_blend_t *blend,
+			       hb_user_data_key_t      *key);
+
+HB_EXTERN unsigned int
+hb_ot_var_blend_get_sample_count (const hb_ot_var_blend_t *blend);
+
+HB_EXTERN hb_position_t
+hb_ot_var_blend_get_glyph_h_advance (const hb_ot_var_blend_t *blend,
+				     hb_codepoint_t           glyph,
+				     float                    value);
+
+HB_EXTERN hb_position_t
+hb_ot_var_blend_get_glyph_v_advance (const hb_ot_var_blend_t *blend,
+				     hb_codepoint_t           glyph,
+				     float                    value);
+
+HB_EXTERN hb_bool_t
+hb_ot_var_blend_draw_glyph (const hb_ot_var_blend_t *blend,
+			    hb_codepoint_t           glyph,
+			    float                    value,
+			    hb_draw_funcs_t         *dfuncs,
+			    void                    *draw_data);
+
+
 HB_END_DECLS
 
 #endif /* HB_OT_VAR_H */
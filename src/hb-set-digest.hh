@@ -158,6 +158,26 @@ struct hb_set_digest_t
     return true;
   }
 
+  /* Tests up to 64 values from @array at once; bit i of the result is
+   * set if array[i] may be in the set.  Branch-free, so the compiler
+   * can vectorize it; used to skip over runs of values quickly. */
+  template <typename T>
+  uint64_t may_have_batch (const T *array, unsigned int count, unsigned int stride=sizeof(T)) const
+  {
+    count = hb_min (count, 64u);
+    uint64_t ret = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      hb_codepoint_t g = *array;
+      mask_t bit = one;
+      for (unsigned j = 0; j < n; j++)
+	bit &= masks[j] >> ((g >> hb_set_digest_shifts[j]) & mb1);
+      ret |= (uint64_t) bit << i;
+      array = &StructAtOffsetUnaligned<T> ((const void *) array, stride);
+    }
+    return ret;
+  }
+
   bool may_intersect (const hb_set_digest_t &o) const
   {
     for (unsigned i = 0; i < n; i++)
@@ -165,6 +165,27 @@ hb_shape_plan_key_t::equal (const hb_shape_plan_key_t *other)
 	 this->shaper_func == other->shaper_func;
 }
 
+uint32_t
+hb_shape_plan_key_t::hash () const
+{
+  /* Only hash what equal() compares; in particular not the feature
+   * ranges, only whether features are global. */
+  uint32_t h = hb_segment_properties_hash (&props);
+  h = h * 31 + hb_hash (num_user_features);
+  for (unsigned int i = 0; i < num_user_features; i++)
+    h = h * 31 + (hb_hash (user_features[i].tag) ^
+		  hb_hash (user_features[i].value) ^
+		  (user_features[i].start == HB_FEATURE_GLOBAL_START &&
+		   user_features[i].end   == HB_FEATURE_GLOBAL_END));
+#ifndef HB_NO_OT_SHAPE
+  h = h * 31 + hb_hash (ot.variations_index[0]);
+  h = h * 31 + hb_hash (ot.variations_index[1]);
+#endif
+  h = h * 31 + hb_hash ((uintptr_t) shaper_func);
+  return h;
+}
+
+
 
 /*
  * hb_shape_plan_t
@@ -491,6 +512,252 @@ hb_shape_plan_create_cached (hb_face_t                     *face,
 				       shaper_list);
 }
 
+hb_shape_plan_cache_t::~hb_shape_plan_cache_t ()
+{
+  for (node_t *node : clock)
+  {
+    hb_shape_plan_destroy (node->shape_plan);
+    hb_free (node);
+  }
+  for (node_t *node : retired)
+  {
+    hb_shape_plan_destroy (node->shape_plan);
+    hb_free (node);
+  }
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::get (const hb_shape_plan_key_t *key, uint32_t hash)
+{
+  hb_shape_plan_t *shape_plan = nullptr;
+
+  bucket_t &bucket = buckets[hash % BUCKETS];
+  bucket.readers.inc ();
+  for (node_t *node = bucket.head.get_acquire (); node; node = node->next.get_acquire ())
+    if (node->hash == hash && node->shape_plan->key.equal (key))
+    {
+      node->hits.set_relaxed (node->hits.get_relaxed () + 1);
+      shape_plan = hb_shape_plan_reference (node->shape_plan);
+      break;
+    }
+  bucket.readers.dec ();
+
+  if (!shape_plan)
+    misses.set_relaxed (misses.get_relaxed () + 1);
+  return shape_plan;
+}
+
+hb_shape_plan_t *
+hb_shape_plan_cache_t::insert (hb_shape_plan_t *shape_plan, uint32_t hash,
+			       unsigned capacity)
+{
+  hb_lock_t l (lock);
+
+  /* Another thread might have cached an equal plan meanwhile. */
+  for (node_t *node = buckets[hash % BUCKETS].head.get_relaxed (); node; node = node->next.get_relaxed ())
+    if (node->hash == hash && node->shape_plan->key.equal (&shape_plan->key))
+    {
+      hb_shape_plan_destroy (shape_plan);
+      node->seen_hits = node->hits.get_relaxed () - 1; /* Mark as used. */
+      return hb_shape_plan_reference (node->shape_plan);
+    }
+
+  if (!capacity)
+    return shape_plan;
+
+  while (clock.length >= capacity)
+    if (unlikely (!evict_one ()))
+      return shape_plan;
+  reclaim ();
+
+  node_t *node = (node_t *) hb_calloc (1, sizeof (node_t));
+  if (unlikely (!node))
+    return shape_plan;
+  clock.push (node);
+  if (unlikely (clock.in_error ()))
+  {
+    clock.reset_error ();
+    hb_free (node);
+    return shape_plan;
+  }
+
+  node->shape_plan = shape_plan;
+  node->hash = hash;
+  link (node);
+  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
+
+  return hb_shape_plan_reference (shape_plan);
+}
+
+void
+hb_shape_plan_cache_t::shrink (unsigned capacity)
+{
+  hb_lock_t l (lock);
+
+  while (clock.length > capacity)
+    if (unlikely (!evict_one ()))
+      break;
+  reclaim ();
+}
+
+void
+hb_shape_plan_cache_t::get_stats (unsigned *num_plans, unsigned *hits_, unsigned *misses_)
+{
+  hb_lock_t l (lock);
+
+  unsigned hits = evicted_hits;
+  for (node_t *node : clock)
+    hits += node->hits.get_relaxed ();
+
+  if (num_plans) *num_plans = clock.length;
+  if (hits_) *hits_ = hits;
+  if (misses_) *misses_ = misses.get_relaxed ();
+}
+
+/* Publishes a fully set up node at the head of its bucket. */
+void
+hb_shape_plan_cache_t::link (node_t *node)
+{
+  auto &head = buckets[node->hash % BUCKETS].head;
+  node->next.set_relaxed (head.get_relaxed ());
+  head.cmpexch (node->next.get_relaxed (), node);
+}
+
+bool
+hb_shape_plan_cache_t::evict_one ()
+{
+  if (unlikely (!retired.alloc (retired.length + 1)))
+    return false;
+
+  for (;;)
+  {
+    if (hand >= clock.length)
+      hand = 0;
+    node_t *node = clock.arrayZ[hand];
+    unsigned hits = node->hits.get_relaxed ();
+    if (hits != node->seen_hits)
+    {
+      node->seen_hits = hits;
+      hand++;
+      continue;
+    }
+
+    /* Lookups already at the node keep following its next pointer. */
+    hb_atomic_t<node_t *> *p = &buckets[node->hash % BUCKETS].head;
+    while (p->get_relaxed () != node)
+      p = &p->get_relaxed ()->next;
+    p->cmpexch (node, node->next.get_relaxed ());
+    clock.arrayZ[hand] = clock.tail ();
+    clock.pop ();
+    evicted_hits += hits;
+
+    DEBUG_MSG_FUNC (SHAPE_PLAN, node->shape_plan, "evicted from cache");
+    retired.push (node);
+    return true;
+  }
+}
+
+/* Frees the evicted nodes no lookup is walking the bucket of.  A lookup
+ * starting afterwards sees them unlinked, as the read-modify-write here
+ * and its own on the reader count are ordered. */
+void
+hb_shape_plan_cache_t::reclaim ()
+{
+  unsigned j = 0;
+  for (node_t *node : retired)
+  {
+    bucket_t &bucket = buckets[node->hash % BUCKETS];
+    bool idle = bucket.readers.inc () == 0;
+    bucket.readers.dec ();
+    if (!idle)
+    {
+      retired.arrayZ[j++] = node;
+      continue;
+    }
+
+    /* Users still holding a reference keep the plan alive. */
+    hb_shape_plan_destroy (node->shape_plan);
+    hb_free (node);
+  }
+  retired.resize (j);
+}
+
+static hb_shape_plan_cache_t *
+_hb_face_get_shape_plan_cache (hb_face_t *face)
+{
+retry:
+  hb_shape_plan_cache_t *cache = face->shape_plans.get_acquire ();
+  if (unlikely (!cache))
+  {
+    cache = (hb_shape_plan_cache_t *) hb_calloc (1, sizeof (hb_shape_plan_cache_t));
+    if (unlikely (!cache))
+      return nullptr;
+    cache = new (cache) hb_shape_plan_cache_t ();
+    if (unlikely (!face->shape_plans.cmpexch (nullptr, cache)))
+    {
+      cache->~hb_shape_plan_cache_t ();
+      hb_free (cache);
+      goto retry;
+    }
+  }
+  return cache;
+}
+
+hb_shape_plan_t *
+hb_shape_plan_get_cached (hb_font_t                     *font,
+			  const hb_segment_properties_t *props,
+			  const hb_feature_t            *user_features,
+			  unsigned int                   num_user_features,
+			  const char * const            *shaper_list,
+			  bool                          *borrowed)
+{
+  *borrowed = false;
+
+  hb_shape_plan_key_t key;
+  if (likely (hb_object_is_valid (font->face) &&
+	      key.init (false,
+			font->face,
+			props,
+			user_features,
+			num_user_features,
+			font->coords,
+			font->num_coords,
+			shaper_list)))
+    for (auto &slot : font->shape_plans)
+    {
+      hb_shape_plan_t *shape_plan = slot.get_acquire ();
+      if (!shape_plan)
+	break;
+      if (shape_plan->key.equal (&key))
+      {
+	*borrowed = true;
+	return shape_plan;
+      }
+    }
+
+  hb_shape_plan_t *shape_plan = hb_shape_plan_create_cached2 (font->face, props,
+							      user_features, num_user_features,
+							      font->coords, font->num_coords,
+							      shaper_list);
+  if (unlikely (shape_plan->header.is_inert ()))
+    return shape_plan;
+
+  /* Hand our reference over to the font, if it has room left. */
+  for (auto &slot : font->shape_plans)
+  {
+    hb_shape_plan_t *other = slot.get_acquire ();
+    if (!other && slot.cmpexch (nullptr, shape_plan))
+    {
+      *borrowed = true;
+      return shape_plan;
+    }
+    other = slot.get_acquire ();
+    if (other == shape_plan || other->key.equal (&shape_plan->key))
+      break; /* Another thread got there first. */
+  }
+  return shape_plan;
+}
+
 /**
  * hb_shape_plan_create_cached2:
  * @face: #hb_face_t to use
@@ -525,12 +792,9 @@ hb_shape_plan_create_cached2 (hb_face_t                     *face,
 		  num_user_features,
 		  shaper_list);
 
-retry:
-  hb_face_t::plan_node_t *cached_plan_nodes = face->shape_plans;
-
-  bool dont_cache = !hb_object_is_valid (face);
-
-  if (likely (!dont_cache))
+  hb_shape_plan_cache_t *cache = nullptr;
+  uint32_t hash = 0;
+  if (likely (hb_object_is_valid (face)))
   {
     hb_shape_plan_key_t key;
     if (!key.init (false,
@@ -543,11 +807,13 @@ retry:
 		   shaper_list))
       return hb_shape_plan_get_empty ();
 
-    for (hb_face_t::plan_node_t *node = cached_plan_nodes; node; node = node->next)
-      if (node->shape_plan->key.equal (&key))
+    hash = key.hash ();
+    cache = _hb_face_get_shape_plan_cache (face);
+    if (likely (cache))
+      if (hb_shape_plan_t *shape_plan = cache->get (&key, hash))
       {
-	DEBUG_MSG_FUNC (SHAPE_PLAN, node->shape_plan, "fulfilled from cache");
-	return hb_shape_plan_reference (node->shape_plan);
+	DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "fulfilled from cache");
+	return shape_plan;
       }
   }
 
@@ -556,25 +822,77 @@ retry:
 						       coords, num_coords,
 						       shaper_list);
 
-  if (unlikely (dont_cache))
+  if (unlikely (!cache || shape_plan->header.is_inert ()))
     return shape_plan;
 
-  hb_face_t::plan_node_t *node = (hb_face_t::plan_node_t *) hb_calloc (1, sizeof (hb_face_t::plan_node_t));
-  if (unlikely (!node))
-    return shape_plan;
+  return cache->insert (shape_plan, hash, face->shape_plans_capacity.get_relaxed ());
+}
 
-  node->shape_plan = shape_plan;
-  node->next = cached_plan_nodes;
+/**
+ * hb_shape_plan_cache_set_capacity:
+ * @face: #hb_face_t to work upon
+ * @capacity: Maximum number of shaping plans to cache
+ *
+ * Sets the maximum number of shaping plans that
+ * hb_shape_plan_create_cached2() and friends will cache on @face.
+ * Once the cache is full, a plan for a new combination of segment
+ * properties, features and variations replaces one that has not been
+ * used recently.  Lowering the capacity evicts plans right away.
+ * Evicted plans are freed once nobody holds a reference to them.
+ *
+ * Setting a capacity of zero disables caching.
+ *
+ * The default capacity is large enough for typical use; this is useful
+ * for tuning applications that shape with a very large number of
+ * different feature sets or variation instances per face.  Use
+ * hb_shape_plan_cache_get_stats() to measure the cache effectiveness.
+ *
+ * Unlike most face setters, this can be called on an immutable face.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_shape_plan_cache_set_capacity (hb_face_t    *face,
+				  unsigned int  capacity)
+{
+  if (unlikely (!hb_object_is_valid (face)))
+    return;
+
+  face->shape_plans_capacity = capacity;
+  if (hb_shape_plan_cache_t *cache = face->shape_plans.get_acquire ())
+    cache->shrink (capacity);
+}
 
-  if (unlikely (!face->shape_plans.cmpexch (cached_plan_nodes, node)))
+/**
+ * hb_shape_plan_cache_get_stats:
+ * @face: #hb_face_t to work upon
+ * @num_plans: (out) (optional): Number of shaping plans currently cached
+ * @hits: (out) (optional): Number of cached plan requests that were
+ *   fulfilled from the cache
+ * @misses: (out) (optional): Number of cached plan requests that had to
+ *   create a new plan
+ *
+ * Fetches statistics about the shaping-plan cache of @face.  The counters
+ * wrap around on overflow.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_shape_plan_cache_get_stats (hb_face_t    *face,
+			       unsigned int *num_plans, /* OUT */
+			       unsigned int *hits,      /* OUT */
+			       unsigned int *misses     /* OUT */)
+{
+  hb_shape_plan_cache_t *cache = hb_object_is_valid (face) ? face->shape_plans.get_acquire () : nullptr;
+  if (!cache)
   {
-    hb_shape_plan_destroy (shape_plan);
-    hb_free (node);
-    goto retry;
+    if (num_plans) *num_plans = 0;
+    if (hits) *hits = 0;
+    if (misses) *misses = 0;
+    return;
   }
-  DEBUG_MSG_FUNC (SHAPE_PLAN, shape_plan, "inserted into cache");
 
-  return hb_shape_plan_reference (shape_plan);
+  cache->get_stats (num_plans, hits, misses);
 }
 
 
@@ -116,6 +116,16 @@ hb_shape_plan_execute (hb_shape_plan_t    *shape_plan,
 HB_EXTERN const char *
 hb_shape_plan_get_shaper (hb_shape_plan_t *shape_plan);
 
+HB_EXTERN void
+hb_shape_plan_cache_set_capacity (hb_face_t    *face,
+				  unsigned int  capacity);
+
+HB_EXTERN void
+hb_shape_plan_cache_get_stats (hb_face_t    *face,
+			       unsigned int *num_plans, /* OUT */
+			       unsigned int *hits,      /* OUT */
+			       unsigned int *misses     /* OUT */);
+
 
 HB_END_DECLS
 
@@ -28,6 +28,7 @@
 #define HB_SHAPE_PLAN_HH
 
 #include "hb.hh"
+#include "hb-mutex.hh"
 #include "hb-shaper.hh"
 #include "hb-ot-shape.hh"
 
@@ -60,6 +61,8 @@ struct hb_shape_plan_key_t
   HB_INTERNAL bool user_features_match (const hb_shape_plan_key_t *other);
 
   HB_INTERNAL bool equal (const hb_shape_plan_key_t *other);
+
+  HB_INTERNAL uint32_t hash () const;
 };
 
 struct hb_shape_plan_t
@@ -74,4 +77,82 @@ struct hb_shape_plan_t
 };
 
 
+/* The shape plans cached on a face, hashed into buckets of lists.  Once
+ * the face's capacity is reached, new plans replace old ones in CLOCK
+ * (second-chance) order.  The cache holds a reference on each plan, so
+ * an evicted plan lives on until its last user is done with it.
+ * See hb_shape_plan_create_cached2(). */
+struct hb_shape_plan_cache_t
+{
+  ~hb_shape_plan_cache_t ();
+
+  /* Returns a reference to the cached plan for key, or nullptr. */
+  hb_shape_plan_t *get (const hb_shape_plan_key_t *key, uint32_t hash);
+
+  /* Takes over the reference to shape_plan, and returns a reference to
+   * the cached plan with its key; that is shape_plan itself, unless
+   * another thread cached an equal plan first. */
+  hb_shape_plan_t *insert (hb_shape_plan_t *shape_plan, uint32_t hash,
+			   unsigned capacity);
+
+  /* Evicts plans until at most capacity are cached. */
+  void shrink (unsigned capacity);
+
+  void get_stats (unsigned *num_plans, unsigned *hits, unsigned *misses);
+
+  protected:
+
+  /* Lookups walk the buckets without locking; everything else happens
+   * under the lock.  Evicted nodes are unlinked right away, but only
+   * freed once no lookup is walking their bucket, as nothing else keeps
+   * their plan alive until the lookup references it. */
+  struct node_t
+  {
+    hb_shape_plan_t *shape_plan;
+    hb_atomic_t<node_t *> next;
+    uint32_t hash;
+    /* The only field a lookup writes.  A plan was used since the clock
+     * hand last passed it if its hits moved on from seen_hits. */
+    hb_atomic_t<unsigned> hits;
+    unsigned seen_hits;
+  };
+
+  struct bucket_t
+  {
+    hb_atomic_t<node_t *> head;
+    hb_atomic_t<int> readers; /* Lookups walking the bucket. */
+  };
+
+  void link (node_t *node);
+  bool evict_one ();
+  void reclaim ();
+
+  static constexpr unsigned BUCKETS = 32;
+
+  bucket_t buckets[BUCKETS];
+  hb_atomic_t<unsigned> misses;
+
+  hb_mutex_t lock;
+  hb_vector_t<node_t *> clock;
+  hb_vector_t<node_t *> retired;
+  unsigned hand = 0;
+  unsigned evicted_hits = 0;
+};
+
+
+/* Like hb_shape_plan_create_cached2() for the segment properties,
+ * features and variations of @font, but for frozen fonts; see
+ * hb_font_freeze().  The first few plans the font needs are kept on the
+ * font, and then returned from there without referencing them.  Sets
+ * @borrowed to whether that was the case, or whether the caller owns
+ * the plan and has to destroy it. */
+HB_INTERNAL hb_shape_plan_t *
+hb_shape_plan_get_cached (hb_font_t                     *font,
+			  const hb_segment_properties_t *props,
+			  const hb_feature_t            *user_features,
+			  unsigned int                   num_user_features,
+			  const char * const            *shaper_list,
+			  bool                          *borrowed);
+
+
 #endif /* HB_SHAPE_PLAN_HH */
@@ -33,6 +33,8 @@
 #include "hb-buffer.hh"
 #include "hb-font.hh"
 #include "hb-machinery.hh"
+#include "hb-ot-layout.hh"
+#include "hb-executor.hh"
 
 
 #ifndef HB_NO_SHAPER
@@ -142,14 +144,24 @@ hb_shape_full (hb_font_t          *font,
     hb_buffer_append (text_buffer, buffer, 0, -1);
   }
 
-  hb_shape_plan_t *shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
+  /* Frozen fonts skip locking the plan cache and reference counting the
+   * plan, which would otherwise be the only atomic read-modify-writes
+   * left on their hot path. */
+  bool borrowed = false;
+  hb_shape_plan_t *shape_plan = font->frozen ?
+				hb_shape_plan_get_cached (font, &buffer->props,
+							  features, num_features,
+							  shaper_list,
+							  &borrowed) :
+				hb_shape_plan_create_cached2 (font->face, &buffer->props,
 							      features, num_features,
 							      font->coords, font->num_coords,
 							      shaper_list);
 
   hb_bool_t res = hb_shape_plan_execute (shape_plan, font, buffer, features, num_features);
 
-  hb_shape_plan_destroy (shape_plan);
+  if (!borrowed)
+    hb_shape_plan_destroy (shape_plan);
 
   if (text_buffer)
   {
@@ -194,6 +206,544 @@ hb_shape (hb_font_t           *font,
   hb_shape_full (font, buffer, features, num_features, nullptr);
 }
 
+/**
+ * hb_shape_batch:
+ * @font: an #hb_font_t to use for shaping
+ * @buffers: (array length=num_buffers): an array of #hb_buffer_t to shape
+ * @num_buffers: the length of @buffers array
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ *
+ * Shapes each of @buffers using @font and @features, as if by calling
+ * hb_shape_full() on each of them in turn.
+ *
+ * Consecutive buffers that share the same segment properties reuse one
+ * shaping plan, saving the plan lookup that would otherwise be done for
+ * each buffer.  This is most useful when shaping many short runs, like
+ * labels or words, with the same script and direction.
+ *
+ * Return value: false if all shapers failed for any of the buffers,
+ * true otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_shape_batch (hb_font_t          *font,
+		hb_buffer_t       **buffers,
+		unsigned int        num_buffers,
+		const hb_feature_t *features,
+		unsigned int        num_features,
+		const char * const *shaper_list)
+{
+  hb_bool_t ret = true;
+  hb_shape_plan_t *shape_plan = nullptr;
+
+  for (unsigned i = 0; i < num_buffers; i++)
+  {
+    hb_buffer_t *buffer = buffers[i];
+
+    if (unlikely (!buffer->len))
+      continue;
+
+    if (unlikely (buffer->flags & HB_BUFFER_FLAG_VERIFY))
+    {
+      ret = hb_shape_full (font, buffer, features, num_features, shaper_list) && ret;
+      continue;
+    }
+
+    if (!shape_plan ||
+	!hb_segment_properties_equal (&shape_plan->key.props, &buffer->props))
+    {
+      hb_shape_plan_destroy (shape_plan);
+      shape_plan = hb_shape_plan_create_cached2 (font->face, &buffer->props,
+						 features, num_features,
+						 font->coords, font->num_coords,
+						 shaper_list);
+    }
+
+    buffer->enter ();
+    ret = hb_shape_plan_execute (shape_plan, font, buffer, features, num_features) && ret;
+    buffer->leave ();
+  }
+
+  hb_shape_plan_destroy (shape_plan);
+
+  return ret;
+}
+
+/**
+ * hb_font_warm:
+ * @font: an #hb_font_t to prepare
+ * @props: the segment properties of the text that will be shaped
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ * @shaper_list: (array zero-terminated=1) (nullable): a `NULL`-terminated
+ *    array of shapers to use or `NULL`
+ * @executor: (nullable): The executor to build lookup accelerators on
+ *
+ * Prepares @font for shaping text with @props and @features, doing the
+ * work the first hb_shape_full() call with the same arguments would
+ * otherwise do lazily: the shaping plan is created and cached on the
+ * face, the tables of the face are loaded, the accelerators of the
+ * lookups the plan applies are built, and so are the shaper data and,
+ * for the built-in OpenType font functions, the glyph caches of @font.
+ *
+ * If @executor is not `NULL`, the lookup accelerators are built as
+ * separate tasks on it, as with hb_face_warm().
+ *
+ * Call this once for each script and language that is going to be
+ * shaped.  To prepare every lookup of a face regardless of script, use
+ * hb_face_warm().  The direction of @props must be set, for example
+ * with hb_buffer_guess_segment_properties().
+ *
+ * It is safe to call this function from any thread, including while
+ * @font is being used for shaping on other threads.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_font_warm (hb_font_t                     *font,
+	      const hb_segment_properties_t *props,
+	      const hb_feature_t            *features,
+	      unsigned int                   num_features,
+	      const char * const            *shaper_list,
+	      hb_executor_t                 *executor)
+{
+  if (unlikely (font->header.is_inert () ||
+		!HB_DIRECTION_IS_VALID (props->direction)))
+    return;
+
+  hb_face_t *face = font->face;
+  face->table.warm ();
+#define HB_SHAPER_IMPLEMENT(shaper) (void) !font->data.shaper;
+#include "hb-shaper-list.hh"
+#undef HB_SHAPER_IMPLEMENT
+#ifndef HB_NO_OT_FONT
+  _hb_ot_font_warm (font);
+#endif
+
+  hb_shape_plan_t *shape_plan = hb_shape_plan_create_cached2 (face, props,
+							      features, num_features,
+							      font->coords, font->num_coords,
+							      shaper_list);
+#if !defined(HB_NO_OT_SHAPE) && !defined(HB_NO_OT_LAYOUT)
+  hb_set_t gsub_lookups, gpos_lookups;
+  hb_ot_shape_plan_collect_lookups (shape_plan, HB_OT_TAG_GSUB, &gsub_lookups);
+  hb_ot_shape_plan_collect_lookups (shape_plan, HB_OT_TAG_GPOS, &gpos_lookups);
+  hb_ot_layout_warm_lookups (face, &gsub_lookups, &gpos_lookups,
+			     executor ? executor : hb_executor_get_empty ());
+#endif
+  hb_shape_plan_destroy (shape_plan);
+}
+
+
+/*
+ * hb_shape_cache_t
+ */
+
+/* Runs longer than this are shaped directly; caching them is
+ * rarely a win and would make entry size unbounded. */
+#ifndef HB_SHAPE_CACHE_MAX_LEN
+#define HB_SHAPE_CACHE_MAX_LEN 64
+#endif
+
+struct hb_shape_cache_entry_t
+{
+  ~hb_shape_cache_entry_t () { hb_font_destroy (font); }
+
+  bool equal (const hb_font_t *font_,
+	      const hb_unicode_funcs_t *unicode_,
+	      hb_language_t language_,
+	      const hb_vector_t<uint32_t> &key_) const
+  {
+    return font == font_ &&
+	   unicode == unicode_ &&
+	   language == language_ &&
+	   key == key_;
+  }
+
+  hb_font_t *font; /* Referenced. */
+  const hb_unicode_funcs_t *unicode;
+  hb_language_t language;
+  hb_vector_t<uint32_t> key;
+
+  uint32_t random_state;
+  hb_vector_t<hb_glyph_info_t> info;
+  hb_vector_t<hb_glyph_position_t> pos;
+};
+
+struct hb_shape_cache_t
+{
+  hb_object_header_t header;
+  hb_mutex_t lock_;
+  hb_vector_t<hb_shape_cache_entry_t *> buckets;
+
+  hb_shape_cache_t (unsigned max_entries)
+  {
+    unsigned size = 1;
+    while (size < max_entries && size < (1u << 24))
+      size <<= 1;
+    if (unlikely (!buckets.resize (size)))
+      buckets.resize (0);
+  }
+  ~hb_shape_cache_t () { clear (); }
+
+  void clear ()
+  {
+    hb_lock_t lock (lock_);
+    for (auto &entry : buckets)
+    {
+      if (entry)
+      {
+	entry->~hb_shape_cache_entry_t ();
+	hb_free (entry);
+      }
+      entry = nullptr;
+    }
+  }
+
+  /* Serializes everything, except for the font, unicode-funcs and
+   * language pointers, that can influence the shaping result of
+   * @buffer into @key. */
+  static bool make_key (hb_vector_t<uint32_t> &key,
+			hb_font_t *font,
+			const hb_buffer_t *buffer,
+			const hb_feature_t *features,
+			unsigned num_features)
+  {
+    if (unlikely (!key.alloc (16 + 2 * hb_buffer_t::CONTEXT_LENGTH +
+			      4 * num_features +
+			      2 * buffer->len, true)))
+      return false;
+
+    key.push (font->serial.get_acquire ());
+    key.push (buffer->props.direction);
+    key.push (buffer->props.script);
+    key.push (buffer->flags);
+    key.push (buffer->cluster_level);
+    key.push (buffer->replacement);
+    key.push (buffer->invisible);
+    key.push (buffer->not_found);
+    key.push (buffer->not_found_variation_selector);
+    key.push (buffer->random_state);
+    for (unsigned i = 0; i < 2; i++)
+    {
+      key.push (buffer->context_len[i]);
+      for (unsigned j = 0; j < buffer->context_len[i]; j++)
+	key.push (buffer->context[i][j]);
+    }
+    key.push (num_features);
+    for (unsigned i = 0; i < num_features; i++)
+    {
+      key.push (features[i].tag);
+      key.push (features[i].value);
+      key.push (features[i].start);
+      key.push (features[i].end);
+    }
+    key.push (buffer->len);
+    for (unsigned i = 0; i < buffer->len; i++)
+    {
+      key.push (buffer->info[i].codepoint);
+      key.push (buffer->info[i].cluster);
+    }
+
+    return likely (!key.in_error ());
+  }
+
+  static uint32_t hash (const hb_font_t *font,
+			const hb_buffer_t *buffer,
+			const hb_vector_t<uint32_t> &key)
+  {
+    return key.hash () ^
+	   hb_hash ((uintptr_t) font) ^
+	   hb_hash ((uintptr_t) buffer->unicode) ^
+	   hb_hash ((uintptr_t) buffer->props.language);
+  }
+
+  bool lookup (hb_font_t *font,
+	       hb_buffer_t *buffer,
+	       const hb_vector_t<uint32_t> &key,
+	       uint32_t hash)
+  {
+    hb_lock_t lock (lock_);
+
+    hb_shape_cache_entry_t *entry = buckets.arrayZ[hash & (buckets.length - 1)];
+    if (!entry ||
+	!entry->equal (font, buffer->unicode, buffer->props.language, key))
+      return false;
+
+    unsigned count = entry->info.length;
+    if (unlikely (!buffer->ensure (count)))
+      return false;
+
+    hb_memcpy (buffer->info, entry->info.arrayZ, count * sizeof (buffer->info[0]));
+    hb_memcpy (buffer->pos, entry->pos.arrayZ, count * sizeof (buffer->pos[0]));
+    buffer->len = count;
+    buffer->have_output = false;
+    buffer->have_positions = true;
+    buffer->random_state = entry->random_state;
+    buffer->content_type = HB_BUFFER_CONTENT_TYPE_GLYPHS;
+
+    return true;
+  }
+
+  void insert (hb_font_t *font,
+	       const hb_buffer_t *buffer,
+	       hb_vector_t<uint32_t> &&key,
+	       uint32_t hash)
+  {
+    hb_shape_cache_entry_t *entry = (hb_shape_cache_entry_t *) hb_calloc (1, sizeof (hb_shape_cache_entry_t));
+    if (unlikely (!entry))
+      return;
+    new (entry) hb_shape_cache_entry_t ();
+
+    entry->unicode = buffer->unicode;
+    entry->language = buffer->props.language;
+    entry->key = std::move (key);
+    entry->random_state = buffer->random_state;
+    entry->info.extend (hb_array (buffer->info, buffer->len));
+    entry->pos.extend (hb_array (buffer->pos, buffer->len));
+    if (unlikely (entry->info.in_error () || entry->pos.in_error ()))
+    {
+      entry->~hb_shape_cache_entry_t ();
+      hb_free (entry);
+      return;
+    }
+    entry->font = hb_font_reference (font);
+
+    hb_shape_cache_entry_t *old;
+    {
+      hb_lock_t lock (lock_);
+      hb_shape_cache_entry_t *&bucket = buckets.arrayZ[hash & (buckets.length - 1)];
+      old = bucket;
+      bucket = entry;
+    }
+    if (old)
+    {
+      /* Destroying the old entry can release the last reference to
+       * its font; do that outside of the lock. */
+      old->~hb_shape_cache_entry_t ();
+      hb_free (old);
+    }
+  }
+};
+
+/**
+ * hb_shape_cache_create:
+ * @max_entries: Maximum number of shaped runs to remember
+ *
+ * Creates a new shaping-result cache, for use with hb_shape_cache_shape().
+ *
+ * The cache memoizes the glyphs and positions produced for short runs of
+ * text, keyed on the font (including its serial number, which changes
+ * whenever the font, its scale or its variation coordinates change), the
+ * buffer's contents, properties and flags, and the user features.
+ * When the same run is shaped again the result is copied out of the cache
+ * instead of running the shaper.
+ *
+ * The cache holds at most @max_entries runs (rounded up to a power of two);
+ * older entries are replaced as new runs are inserted.  A cache can be
+ * shared between threads.
+ *
+ * The cache keeps a reference on every font it has entries for, until
+ * the entries are evicted or the cache is cleared or destroyed.
+ *
+ * Return value: (transfer full): The new #hb_shape_cache_t
+ *
+ * Since: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_create (unsigned int max_entries)
+{
+  hb_shape_cache_t *cache;
+
+  if (unlikely (!max_entries) ||
+      !(cache = hb_object_create<hb_shape_cache_t> (max_entries)))
+    return hb_shape_cache_get_empty ();
+
+  if (unlikely (!cache->buckets.length))
+  {
+    hb_shape_cache_destroy (cache);
+    return hb_shape_cache_get_empty ();
+  }
+
+  return cache;
+}
+
+/**
+ * hb_shape_cache_get_empty:
+ *
+ * Fetches the singleton empty #hb_shape_cache_t.  Shaping through
+ * the empty cache is equivalent to calling hb_shape() directly.
+ *
+ * Return value: (transfer full): The empty #hb_shape_cache_t
+ *
+ * Since: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_get_empty ()
+{
+  return const_cast<hb_shape_cache_t *> (&Null (hb_shape_cache_t));
+}
+
+/**
+ * hb_shape_cache_reference: (skip)
+ * @cache: A shaping-result cache
+ *
+ * Increases the reference count on @cache.
+ *
+ * Return value: (transfer full): The cache
+ *
+ * Since: REPLACEME
+ **/
+hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache)
+{
+  return hb_object_reference (cache);
+}
+
+/**
+ * hb_shape_cache_destroy: (skip)
+ * @cache: A shaping-result cache
+ *
+ * Decreases the reference count on @cache. When the
+ * reference count reaches zero, the cache is destroyed,
+ * releasing all cached results and font references.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_shape_cache_destroy (hb_shape_cache_t *cache)
+{
+  if (!hb_object_destroy (cache)) return;
+
+  hb_free (cache);
+}
+
+/**
+ * hb_shape_cache_set_user_data: (skip)
+ * @cache: A shaping-result cache
+ * @key: The user-data key to set
+ * @data: A pointer to the user data to set
+ * @destroy: (nullable): A callback to call when @data is not needed anymore
+ * @replace: Whether to replace an existing data with the same key
+ *
+ * Attaches a user-data key/data pair to the specified cache.
+ *
+ * Return value: `true` if success, `false` otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace)
+{
+  return hb_object_set_user_data (cache, key, data, destroy, replace);
+}
+
+/**
+ * hb_shape_cache_get_user_data: (skip)
+ * @cache: A shaping-result cache
+ * @key: The user-data key to query
+ *
+ * Fetches the user data associated with the specified key,
+ * attached to the specified cache.
+ *
+ * Return value: (transfer none): A pointer to the user data
+ *
+ * Since: REPLACEME
+ **/
+void *
+hb_shape_cache_get_user_data (const hb_shape_cache_t *cache,
+			      hb_user_data_key_t     *key)
+{
+  return hb_object_get_user_data (cache, key);
+}
+
+/**
+ * hb_shape_cache_clear:
+ * @cache: A shaping-result cache
+ *
+ * Drops all results stored in @cache, releasing the
+ * font references they hold.
+ *
+ * Since: REPLACEME
+ **/
+void
+hb_shape_cache_clear (hb_shape_cache_t *cache)
+{
+  if (unlikely (hb_object_is_immutable (cache)))
+    return;
+
+  cache->clear ();
+}
+
+/**
+ * hb_shape_cache_shape:
+ * @cache: A shaping-result cache
+ * @font: an #hb_font_t to use for shaping
+ * @buffer: an #hb_buffer_t to shape
+ * @features: (array length=num_features) (nullable): an array of user
+ *    specified #hb_feature_t or `NULL`
+ * @num_features: the length of @features array
+ *
+ * Same as hb_shape(), but looks the run up in @cache first, and
+ * stores the result there after shaping.
+ *
+ * Buffers that are long, that have a message function set, or that
+ * have %HB_BUFFER_FLAG_VERIFY set, bypass the cache.
+ *
+ * The cache assumes that the font functions of @font return the same
+ * results as long as the font serial number does not change.  Clients
+ * that change the data behind custom font functions must call
+ * hb_font_changed() or hb_shape_cache_clear().
+ *
+ * Return value: false if all shapers failed, true otherwise
+ *
+ * Since: REPLACEME
+ **/
+hb_bool_t
+hb_shape_cache_shape (hb_shape_cache_t   *cache,
+		      hb_font_t          *font,
+		      hb_buffer_t        *buffer,
+		      const hb_feature_t *features,
+		      unsigned int        num_features)
+{
+  if (unlikely (!buffer->len))
+    return true;
+
+  if (unlikely (hb_object_is_immutable (cache) ||
+		buffer->len > HB_SHAPE_CACHE_MAX_LEN ||
+		buffer->content_type != HB_BUFFER_CONTENT_TYPE_UNICODE ||
+		buffer->messaging () ||
+		(buffer->flags & HB_BUFFER_FLAG_VERIFY)))
+    return hb_shape_full (font, buffer, features, num_features, nullptr);
+
+  hb_vector_t<uint32_t> key;
+  if (unlikely (!hb_shape_cache_t::make_key (key, font, buffer, features, num_features)))
+    return hb_shape_full (font, buffer, features, num_features, nullptr);
+
+  uint32_t hash = hb_shape_cache_t::hash (font, buffer, key);
+
+  if (cache->lookup (font, buffer, key, hash))
+    return true;
+
+  if (!hb_shape_full (font, buffer, features, num_features, nullptr))
+    return false;
+
+  if (likely (buffer->successful))
+    cache->insert (font, buffer, std::move (key), hash);
+
+  return true;
+}
+
 
 #ifdef HB_EXPERIMENTAL_API
 #ifndef HB_NO_VAR
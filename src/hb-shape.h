@@ -35,6 +35,7 @@
 
 #include "hb-common.h"
 #include "hb-buffer.h"
+#include "hb-executor.h"
 #include "hb-font.h"
 
 HB_BEGIN_DECLS
@@ -53,6 +54,22 @@ hb_shape_full (hb_font_t          *font,
 	       unsigned int        num_features,
 	       const char * const *shaper_list);
 
+HB_EXTERN hb_bool_t
+hb_shape_batch (hb_font_t          *font,
+		hb_buffer_t       **buffers,
+		unsigned int        num_buffers,
+		const hb_feature_t *features,
+		unsigned int        num_features,
+		const char * const *shaper_list);
+
+HB_EXTERN void
+hb_font_warm (hb_font_t                     *font,
+	      const hb_segment_properties_t *props,
+	      const hb_feature_t            *features,
+	      unsigned int                   num_features,
+	      const char * const            *shaper_list,
+	      hb_executor_t                 *executor);
+
 #ifdef HB_EXPERIMENTAL_API
 HB_EXTERN hb_bool_t
 hb_shape_justify (hb_font_t          *font,
@@ -71,6 +88,49 @@ HB_EXTERN const char **
 hb_shape_list_shapers (void);
 
 
+/**
+ * hb_shape_cache_t:
+ *
+ * Data type for holding a cache of shaping results.
+ *
+ * Since: REPLACEME
+ **/
+typedef struct hb_shape_cache_t hb_shape_cache_t;
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_create (unsigned int max_entries);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_get_empty (void);
+
+HB_EXTERN hb_shape_cache_t *
+hb_shape_cache_reference (hb_shape_cache_t *cache);
+
+HB_EXTERN void
+hb_shape_cache_destroy (hb_shape_cache_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_set_user_data (hb_shape_cache_t   *cache,
+			      hb_user_data_key_t *key,
+			      void *              data,
+			      hb_destroy_func_t   destroy,
+			      hb_bool_t           replace);
+
+HB_EXTERN void *
+hb_shape_cache_get_user_data (const hb_shape_cache_t *cache,
+			      hb_user_data_key_t     *key);
+
+HB_EXTERN void
+hb_shape_cache_clear (hb_shape_cache_t *cache);
+
+HB_EXTERN hb_bool_t
+hb_shape_cache_shape (hb_shape_cache_t   *cache,
+		      hb_font_t          *font,
+		      hb_buffer_t        *buffer,
+		      const hb_feature_t *features,
+		      unsigned int        num_features);
+
+
 HB_END_DECLS
 
 #endif /* HB_SHAPE_H */
@@ -334,6 +334,52 @@ hb_subset_input_set_flags (hb_subset_input_t *input,
   input->flags = (hb_subset_flags_t) value;
 }
 
+/**
+ * hb_subset_input_set_executor:
+ * @input: a #hb_subset_input_t object.
+ * @executor: (nullable): the executor to run independent tasks on
+ *
+ * Sets the executor that hb_subset_plan_execute_or_fail() uses to
+ * subset independent tables concurrently.  Plans created from @input
+ * keep a reference to it.
+ *
+ * The subset produced is identical to the one produced without an
+ * executor.  Pass %NULL to go back to subsetting tables one after
+ * another, which is the default.
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN void
+hb_subset_input_set_executor (hb_subset_input_t *input,
+			      hb_executor_t     *executor)
+{
+  if (hb_object_is_immutable (input))
+    return;
+
+  if (!executor)
+    executor = hb_executor_get_empty ();
+
+  hb_executor_reference (executor);
+  hb_executor_destroy (input->executor);
+  input->executor = executor;
+}
+
+/**
+ * hb_subset_input_get_executor:
+ * @input: a #hb_subset_input_t object.
+ *
+ * Fetches the executor set with hb_subset_input_set_executor().
+ *
+ * Return value: (transfer none): the executor of @input
+ *
+ * Since: REPLACEME
+ **/
+HB_EXTERN hb_executor_t *
+hb_subset_input_get_executor (const hb_subset_input_t *input)
+{
+  return input->executor;
+}
+
 /**
  * hb_subset_input_set_user_data: (skip)
  * @input: a #hb_subset_input_t object.
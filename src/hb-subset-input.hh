@@ -34,6 +34,7 @@
 #include "hb-map.hh"
 #include "hb-set.hh"
 #include "hb-cplusplus.hh"
+#include "hb-executor.hh"
 #include "hb-font.hh"
 #include "hb-subset-instancer-solver.hh"
 
@@ -88,6 +89,7 @@ struct hb_subset_input_t
   ~hb_subset_input_t ()
   {
     sets.~sets_t ();
+    hb_executor_destroy (executor);
 
 #ifdef HB_EXPERIMENTAL_API
     for (auto _ : name_table_overrides.values ())
@@ -119,6 +121,9 @@ struct hb_subset_input_t
   // If set loca format will always be the long version.
   bool force_long_loca = false;
 
+  // Independent tables are subset through this executor.
+  hb_executor_t *executor = hb_executor_get_empty ();
+
   hb_hashmap_t<hb_tag_t, Triple> axes_location;
   hb_map_t glyph_map;
 #ifdef HB_EXPERIMENTAL_API
@@ -665,6 +665,7 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
 
   attach_accelerator_data = input->attach_accelerator_data;
   force_long_loca = input->force_long_loca;
+  executor = hb_executor_reference (input->executor);
 #ifdef HB_EXPERIMENTAL_API
   force_long_loca = force_long_loca || (flags & HB_SUBSET_FLAGS_IFTB_REQUIREMENTS);
 #endif
@@ -757,6 +758,7 @@ hb_subset_plan_t::hb_subset_plan_t (hb_face_t *face,
 hb_subset_plan_t::~hb_subset_plan_t()
 {
   hb_face_destroy (dest);
+  hb_executor_destroy (executor);
 
   hb_map_destroy (codepoint_to_glyph);
   hb_map_destroy (glyph_map);
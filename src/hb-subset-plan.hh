@@ -139,6 +139,11 @@ struct hb_subset_plan_t
   bool attach_accelerator_data = false;
   bool force_long_loca = false;
 
+  // Runs independent tables' subsetting, concurrently if it can.
+  hb_executor_t *executor = hb_executor_get_empty ();
+  // Guards dest and sanitized_table_cache while doing so.
+  hb_mutex_t tables_lock;
+
   // The glyph subset
   hb_map_t *codepoint_to_glyph; // Needs to be heap-allocated
 
@@ -188,7 +193,7 @@ struct hb_subset_plan_t
   {
     hb_blob_ptr_t<T> operator () (hb_subset_plan_t *plan)
     {
-      hb_lock_t lock (plan->accelerator ? &plan->accelerator->sanitized_table_cache_lock : nullptr);
+      hb_lock_t lock (plan->accelerator ? &plan->accelerator->sanitized_table_cache_lock : &plan->tables_lock);
 
       auto *cache = plan->accelerator ? &plan->accelerator->sanitized_table_cache : &plan->sanitized_table_cache;
       if (cache
@@ -292,6 +297,7 @@ struct hb_subset_plan_t
 		hb_blob_get_length (source_blob));
       hb_blob_destroy (source_blob);
     }
+    hb_lock_t lock (tables_lock);
     return hb_face_builder_add_table (dest, tag, contents);
   }
 };
@@ -252,6 +252,32 @@ _dependencies_satisfied (hb_subset_plan_t *plan, hb_tag_t tag,
   }
 }
 
+/* Tables subset concurrently must not depend on each other's side
+ * effects on the plan.  On top of the dependencies above, which only
+ * matter when instancing, glyf records metrics and bounds that the
+ * metrics tables read, and GDEF records whether it kept its variation
+ * store, which GPOS reads.  Sequentially these are satisfied by tag
+ * order. */
+static bool
+_parallel_dependencies_satisfied (hb_subset_plan_t *plan, hb_tag_t tag,
+				  const hb_set_t &subsetted_tags,
+				  const hb_set_t &pending_subset_tags)
+{
+  switch (tag)
+  {
+  case HB_TAG('h','e','a','d'):
+  case HB_TAG('h','m','t','x'):
+  case HB_TAG('v','m','t','x'):
+  case HB_TAG('m','a','x','p'):
+  case HB_TAG('O','S','/','2'):
+    return !pending_subset_tags.has (HB_TAG('g','l','y','f'));
+  case HB_TAG('G','P','O','S'):
+    return !pending_subset_tags.has (HB_TAG('G','D','E','F'));
+  default:
+    return _dependencies_satisfied (plan, tag, subsetted_tags, pending_subset_tags);
+  }
+}
+
 static bool
 _subset_table (hb_subset_plan_t *plan,
 	       hb_vector_t<char> &buf,
@@ -302,6 +328,79 @@ _subset_table (hb_subset_plan_t *plan,
   return true;
 }
 
+struct _subset_tables_task_t
+{
+  hb_subset_plan_t *plan;
+  hb_array_t<const hb_tag_t> tags;
+  hb_array_t<bool> results;
+
+  static void run (void *data, unsigned i)
+  {
+    auto *task = (const _subset_tables_task_t *) data;
+    if (unlikely (i >= task->tags.length)) return;
+
+    hb_vector_t<char> buf;
+    task->results.arrayZ[i] = _subset_table (task->plan, buf, task->tags.arrayZ[i]);
+  }
+};
+
+/* Subsets @tags through the plan's executor. */
+static bool
+_subset_tables_run (hb_subset_plan_t *plan,
+		    hb_array_t<const hb_tag_t> tags)
+{
+  hb_vector_t<bool> results;
+  if (unlikely (!results.resize (tags.length)))
+    return false;
+
+  _subset_tables_task_t task = {plan, tags, results.as_array ()};
+  plan->executor->run (_subset_tables_task_t::run, &task, tags.length);
+
+  for (bool result : results)
+    if (unlikely (!result))
+      return false;
+  return true;
+}
+
+static bool
+_subset_tables_parallel (hb_subset_plan_t *plan,
+			 hb_set_t &subsetted_tags,
+			 hb_set_t &pending_subset_tags)
+{
+  hb_vector_t<hb_tag_t> ready;
+  while (!pending_subset_tags.is_empty ())
+  {
+    if (subsetted_tags.in_error ()
+	|| pending_subset_tags.in_error ())
+      return false;
+
+    ready.reset ();
+    for (hb_tag_t tag : pending_subset_tags)
+      if (_parallel_dependencies_satisfied (plan, tag,
+					    subsetted_tags,
+					    pending_subset_tags))
+	ready.push (tag);
+    if (unlikely (ready.in_error ()))
+      return false;
+
+    if (!ready)
+    {
+      DEBUG_MSG (SUBSET, nullptr, "Table dependencies unable to be satisfied. Subset failed.");
+      return false;
+    }
+
+    for (hb_tag_t tag : ready)
+    {
+      pending_subset_tags.del (tag);
+      subsetted_tags.add (tag);
+    }
+
+    if (!_subset_tables_run (plan, ready.as_array ()))
+      return false;
+  }
+  return true;
+}
+
 static void _attach_accelerator_data (hb_subset_plan_t* plan,
                                       hb_face_t* face /* IN/OUT */)
 {
@@ -399,6 +498,12 @@ hb_subset_plan_execute_or_fail (hb_subset_plan_t *plan)
 
   bool success = true;
 
+  if (plan->executor->is_concurrent ())
+  {
+    success = _subset_tables_parallel (plan, subsetted_tags, pending_subset_tags);
+    if (unlikely (!success)) goto end;
+  }
+  else
   {
     // Grouping to deallocate buf before calling hb_face_reference (plan->dest).
 
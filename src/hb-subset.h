@@ -176,6 +176,13 @@ HB_EXTERN void
 hb_subset_input_set_flags (hb_subset_input_t *input,
 			   unsigned value);
 
+HB_EXTERN void
+hb_subset_input_set_executor (hb_subset_input_t *input,
+			      hb_executor_t     *executor);
+
+HB_EXTERN hb_executor_t *
+hb_subset_input_get_executor (const hb_subset_input_t *input);
+
 HB_EXTERN hb_bool_t
 hb_subset_input_pin_all_axes_to_default (hb_subset_input_t  *input,
 					 hb_face_t          *face);
@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-cache.hh"
+
+template <typename cache_t>
+static void
+test_cache_basics ()
+{
+  cache_t cache;
+  unsigned v;
+
+  assert (!cache.get (0, &v));
+  assert (!cache.get (1234, &v));
+
+  cache.set (1234, 42);
+  assert (cache.get (1234, &v) && v == 42);
+  assert (!cache.get (1235, &v));
+
+  /* Overflowing keys and values are not stored. */
+  cache.set (1u << 16, 1);
+  assert (!cache.get (1u << 16, &v));
+  cache.set (7, 1u << 16);
+  assert (!cache.get (7, &v));
+
+  cache.set (7, cache_t::MAX_VALUE);
+  assert (cache.get (7, &v) && v == cache_t::MAX_VALUE);
+
+  cache.clear ();
+  assert (!cache.get (1234, &v));
+  assert (!cache.get (7, &v));
+}
+
+template <typename cache_t>
+static void
+test_cache_ways (unsigned ways)
+{
+  cache_t cache;
+  unsigned v;
+
+  /* Keys 256 apart go to the same set. */
+  for (unsigned i = 0; i < ways; i++)
+    cache.set (5 + 256 * i, i);
+  for (unsigned i = 0; i < ways; i++)
+    assert (cache.get (5 + 256 * i, &v) && v == i);
+
+  /* One more evicts the oldest. */
+  cache.set (5 + 256 * ways, ways);
+  assert (!cache.get (5, &v));
+  for (unsigned i = 1; i <= ways; i++)
+    assert (cache.get (5 + 256 * i, &v) && v == i);
+}
+
+static void
+test_sized_cache ()
+{
+  using cache_t = hb_sized_cache_t<16, 16, 8, 12>;
+  unsigned v;
+
+  cache_t *small = cache_t::create (8);
+  cache_t *large = cache_t::create (12);
+  cache_t *clamped = cache_t::create (20);
+  assert (small && large && clamped);
+  assert (small->get_cache_bits () == 8);
+  assert (large->get_cache_bits () == 12);
+  assert (clamped->get_cache_bits () == 12);
+  assert (large->get_size () == 16 * small->get_size ());
+
+  for (unsigned g = 0; g < 4096; g++)
+  {
+    small->set (g, g * 3);
+    large->set (g, g * 3);
+  }
+  for (unsigned g = 0; g < 4096; g++)
+  {
+    assert (large->get (g, &v) && v == g * 3);
+    assert (small->get (g, &v) == (g >= 4096 - 256));
+  }
+
+  cache_t::destroy (clamped);
+  cache_t::destroy (large);
+  cache_t::destroy (small);
+}
+
+int
+main (int argc, char **argv)
+{
+  test_cache_basics<hb_cache_t<16, 16>> ();
+  test_cache_basics<hb_cache_t<16, 16, 8, false>> ();
+  test_cache_basics<hb_cache_t<16, 16, 8, true, 2>> ();
+  test_cache_basics<hb_cache_t<16, 16, 8, true, 4>> ();
+  test_cache_basics<hb_cache_t<16, 8, 8, true, 2>> ();
+
+  test_cache_ways<hb_cache_t<16, 16>> (1);
+  test_cache_ways<hb_cache_t<16, 16, 8, true, 2>> (2);
+  test_cache_ways<hb_cache_t<16, 16, 8, false, 4>> (4);
+
+  test_sized_cache ();
+
+  return 0;
+}
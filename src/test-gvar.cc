@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+
+#include "hb.hh"
+#include "hb-ot-var-gvar-table.hh"
+
+/* The delta kernels must match, bit for bit, the per-point arithmetic
+ * they replace. */
+
+using gvar_accelerator = OT::gvar::accelerator_t;
+
+static unsigned rand_state = 1;
+static unsigned
+rand_next ()
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static bool
+same_bits (float a, float b)
+{
+  return !memcmp (&a, &b, sizeof (a));
+}
+
+static void
+test_add_scaled_deltas ()
+{
+  const float scalars[] = {1.f, -1.f, .5f, .3333333f, -0.7071068f, 1e-3f};
+
+  for (unsigned count = 0; count < 40; count++)
+    for (float scalar : scalars)
+    {
+      int in[40];
+      float out[40], expected[40];
+      for (unsigned i = 0; i < count; i++)
+      {
+	in[i] = (int) (rand_next () % 65536) - 32768;
+	out[i] = expected[i] = (float) ((int) (rand_next () % 2001) - 1000) / 7;
+      }
+
+      gvar_accelerator::add_scaled_deltas (out, in, count, scalar);
+      for (unsigned i = 0; i < count; i++)
+      {
+	expected[i] += in[i] * scalar;
+	hb_always_assert (same_bits (out[i], expected[i]));
+      }
+    }
+}
+
+/* The per-point inference that infer_deltas() replaces. */
+static float
+infer_delta (const float *orig, const float *deltas,
+	     unsigned target, unsigned prev, unsigned next)
+{
+  float target_val = orig[target];
+  float prev_val = orig[prev];
+  float next_val = orig[next];
+  float prev_delta = deltas[prev];
+  float next_delta = deltas[next];
+
+  if (prev_val == next_val)
+    return (prev_delta == next_delta) ? prev_delta : 0.f;
+  else if (target_val <= hb_min (prev_val, next_val))
+    return (prev_val < next_val) ? prev_delta : next_delta;
+  else if (target_val >= hb_max (prev_val, next_val))
+    return (prev_val > next_val) ? prev_delta : next_delta;
+
+  float r = (target_val - prev_val) / (next_val - prev_val);
+  return prev_delta + r * (next_delta - prev_delta);
+}
+
+static void
+test_infer_deltas ()
+{
+  for (unsigned round = 0; round < 2000; round++)
+  {
+    /* Small coordinate ranges, so that ties and clamping are common. */
+    unsigned range = round % 3 ? 8 : 1000;
+    unsigned count = 2 + rand_next () % 30;
+    float orig[32], deltas[32], expected[32];
+    for (unsigned i = 0; i < count; i++)
+    {
+      orig[i] = (float) (rand_next () % range);
+      deltas[i] = expected[i] = (float) ((int) (rand_next () % 201) - 100) / 3;
+    }
+    if (round % 7 == 0)
+      deltas[count - 1] = expected[count - 1] = deltas[0];
+
+    unsigned prev = 0, next = count - 1;
+    for (unsigned i = prev + 1; i < next; i++)
+      expected[i] = infer_delta (orig, deltas, i, prev, next);
+    gvar_accelerator::infer_deltas (deltas, orig, prev + 1, next, prev, next);
+
+    for (unsigned i = 0; i < count; i++)
+      hb_always_assert (same_bits (deltas[i], expected[i]));
+  }
+}
+
+int
+main (int argc, char **argv)
+{
+  test_add_scaled_deltas ();
+  test_infer_deltas ();
+
+  return 0;
+}
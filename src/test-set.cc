@@ -24,6 +24,7 @@
 
 #include "hb.hh"
 #include "hb-set.hh"
+#include "hb-set-digest.hh"
 
 int
 main (int argc, char **argv)
@@ -161,5 +162,30 @@ main (int argc, char **argv)
     hb_always_assert(s.has(2));
   }
 
+  /* Digest batch membership */
+  {
+    hb_set_digest_t d;
+    d.add (10);
+    d.add (700);
+
+    hb_codepoint_t array[70];
+    for (unsigned i = 0; i < ARRAY_LENGTH (array); i++)
+      array[i] = 1000 + i;
+    array[3] = 10;
+    array[63] = 700;
+    array[65] = 10;
+
+    uint64_t expected = 0;
+    for (unsigned i = 0; i < 64; i++)
+      if (d.may_have (array[i]))
+	expected |= (uint64_t) 1 << i;
+    hb_always_assert (expected & ((uint64_t) 1 << 3));
+    hb_always_assert (expected & ((uint64_t) 1 << 63));
+    hb_always_assert (d.may_have_batch (array, ARRAY_LENGTH (array)) == expected);
+    hb_always_assert (d.may_have_batch (array, 3) == (expected & 7));
+    hb_always_assert (d.may_have_batch (array + 65, 5) & 1);
+    hb_always_assert (!hb_set_digest_t ().may_have_batch (array, 64));
+  }
+
   return 0;
 }
@@ -1075,6 +1075,292 @@ test_hb_draw_immutable (void)
   hb_draw_funcs_destroy (draw_funcs);
 }
 
+static unsigned
+_replay_packed (const uint8_t *verbs, unsigned verb_count,
+		const float *points,
+		draw_data_t *draw_data)
+{
+  hb_draw_state_t st = HB_DRAW_STATE_DEFAULT;
+  const float *p = points;
+  for (unsigned i = 0; i < verb_count; i++)
+  {
+    switch (verbs[i])
+    {
+    case HB_DRAW_VERB_MOVE_TO:
+      hb_draw_move_to (funcs, draw_data, &st, p[0], p[1]);
+      p += 2;
+      break;
+    case HB_DRAW_VERB_LINE_TO:
+      hb_draw_line_to (funcs, draw_data, &st, p[0], p[1]);
+      p += 2;
+      break;
+    case HB_DRAW_VERB_QUADRATIC_TO:
+      hb_draw_quadratic_to (funcs, draw_data, &st, p[0], p[1], p[2], p[3]);
+      p += 4;
+      break;
+    case HB_DRAW_VERB_CUBIC_TO:
+      hb_draw_cubic_to (funcs, draw_data, &st, p[0], p[1], p[2], p[3], p[4], p[5]);
+      p += 6;
+      break;
+    case HB_DRAW_VERB_CLOSE_PATH:
+      hb_draw_close_path (funcs, draw_data, &st);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+  }
+  return (p - points) / 2;
+}
+
+static void
+test_hb_draw_glyphs_packed (void)
+{
+  const char *font_files[] = {
+    "fonts/SourceSerifVariable-Roman-VVAR.abc.ttf",
+    "fonts/cff1_seac.otf",
+    "fonts/AdobeVFPrototype.abc.otf",
+    "fonts/varc-ac00-ac01.ttf",
+  };
+  hb_codepoint_t glyphs[8];
+  uint8_t verbs[1024];
+  float points[2 * 2048];
+  unsigned offsets[G_N_ELEMENTS (glyphs) + 1];
+  char str[8192], str2[8192];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  draw_data_t draw_data2 = {
+    .str = str2,
+    .size = sizeof (str2)
+  };
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  for (unsigned variant = 0; variant < 3; variant++)
+  {
+    hb_face_t *face = hb_test_open_font_file (font_files[f]);
+    hb_font_t *font = hb_font_create (face);
+    unsigned glyph_count = hb_face_get_glyph_count (face);
+    hb_face_destroy (face);
+
+    if (variant == 1)
+    {
+      hb_variation_t var = {HB_TAG ('w','g','h','t'), 800};
+      hb_font_set_variations (font, &var, 1);
+    }
+    else if (variant == 2)
+      hb_font_set_synthetic_bold (font, 0.02f, 0.02f, false);
+
+    if (glyph_count > G_N_ELEMENTS (glyphs))
+      glyph_count = G_N_ELEMENTS (glyphs);
+    for (unsigned i = 0; i < glyph_count; i++)
+      glyphs[i] = glyph_count - 1 - i;
+
+    unsigned verb_count = G_N_ELEMENTS (verbs);
+    unsigned point_count = G_N_ELEMENTS (points) / 2;
+    unsigned n = hb_font_draw_glyphs_packed (font, glyph_count,
+					     glyphs, sizeof (glyphs[0]),
+					     &verb_count, verbs,
+					     &point_count, points,
+					     offsets);
+    g_assert_cmpuint (n, ==, glyph_count);
+    g_assert_cmpuint (offsets[0], ==, 0);
+    g_assert_cmpuint (offsets[n], ==, verb_count);
+    g_assert_cmpuint (verb_count, >, 0);
+
+    /* Each glyph matches what hb_font_draw_glyph() draws. */
+    const float *p = points;
+    for (unsigned i = 0; i < n; i++)
+    {
+      draw_data.consumed = 0;
+      hb_font_draw_glyph (font, glyphs[i], funcs, &draw_data);
+
+      draw_data2.consumed = 0;
+      p += 2 * _replay_packed (verbs + offsets[i], offsets[i + 1] - offsets[i], p, &draw_data2);
+
+      g_assert_cmpmem (str, draw_data.consumed, str2, draw_data2.consumed);
+    }
+    g_assert_cmpuint ((p - points) / 2, ==, point_count);
+
+    /* With too little room, drawing stops before the first glyph that
+     * does not fit, and can be resumed from there. */
+    unsigned half = offsets[n] / 2;
+    unsigned m = 0;
+    while (m < n && offsets[m + 1] <= half)
+      m++;
+    uint8_t verbs2[G_N_ELEMENTS (verbs)];
+    float points2[G_N_ELEMENTS (points)];
+    unsigned verb_count2 = half;
+    unsigned point_count2 = G_N_ELEMENTS (points2) / 2;
+    unsigned n2 = hb_font_draw_glyphs_packed (font, glyph_count,
+					      glyphs, sizeof (glyphs[0]),
+					      &verb_count2, verbs2,
+					      &point_count2, points2,
+					      NULL);
+    g_assert_cmpuint (n2, ==, m);
+    g_assert_cmpuint (verb_count2, ==, offsets[m]);
+    g_assert_cmpmem (verbs2, verb_count2, verbs, offsets[m]);
+    g_assert_cmpmem (points2, point_count2 * 2 * sizeof (float),
+		     points, point_count2 * 2 * sizeof (float));
+
+    unsigned verb_count3 = G_N_ELEMENTS (verbs2) - verb_count2;
+    unsigned point_count3 = G_N_ELEMENTS (points2) / 2 - point_count2;
+    unsigned n3 = hb_font_draw_glyphs_packed (font, glyph_count - n2,
+					      glyphs + n2, sizeof (glyphs[0]),
+					      &verb_count3, verbs2 + verb_count2,
+					      &point_count3, points2 + 2 * point_count2,
+					      NULL);
+    g_assert_cmpuint (n2 + n3, ==, n);
+    g_assert_cmpmem (verbs2, verb_count2 + verb_count3, verbs, verb_count);
+    g_assert_cmpmem (points2, (point_count2 + point_count3) * 2 * sizeof (float),
+		     points, point_count * 2 * sizeof (float));
+
+    hb_font_destroy (font);
+  }
+
+  /* Nothing fits. */
+  {
+    hb_codepoint_t glyph = 3;
+    unsigned verb_count = 0, point_count = 0;
+    hb_face_t *face = hb_test_open_font_file (font_files[0]);
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+    g_assert_cmpuint (hb_font_draw_glyphs_packed (font, 1, &glyph, 0,
+						  &verb_count, NULL,
+						  &point_count, NULL,
+						  offsets), ==, 0);
+    g_assert_cmpuint (verb_count, ==, 0);
+    g_assert_cmpuint (point_count, ==, 0);
+    g_assert_cmpuint (offsets[0], ==, 0);
+    hb_font_destroy (font);
+  }
+}
+
+/* Draws every glyph of @font_file at a few instances, through a face with
+ * the cache of @set_size on and one with it off, and compares the results. */
+static void
+_test_hb_draw_face_cache (const char *font_file,
+			  unsigned cache_size,
+			  void (*set_size) (hb_face_t *, unsigned),
+			  unsigned (*get_size) (const hb_face_t *),
+			  void (*get_stats) (hb_face_t *, unsigned *, unsigned *))
+{
+  float weights[] = {200, 550, 900};
+  char str[8192], str2[8192];
+  draw_data_t draw_data = {
+    .str = str,
+    .size = sizeof (str)
+  };
+  draw_data_t draw_data2 = {
+    .str = str2,
+    .size = sizeof (str2)
+  };
+
+  hb_face_t *face = hb_test_open_font_file (font_file);
+  hb_face_t *cached_face = hb_test_open_font_file (font_file);
+  g_assert_cmpuint (get_size (cached_face), ==, 0);
+  set_size (cached_face, cache_size);
+  g_assert_cmpuint (get_size (cached_face), ==, cache_size);
+
+  hb_font_t *fonts[G_N_ELEMENTS (weights)], *cached_fonts[G_N_ELEMENTS (weights)];
+  for (unsigned i = 0; i < G_N_ELEMENTS (weights); i++)
+  {
+    hb_variation_t var = {HB_TAG ('w','g','h','t'), weights[i]};
+    fonts[i] = hb_font_create (face);
+    cached_fonts[i] = hb_font_create (cached_face);
+    hb_font_set_variations (fonts[i], &var, 1);
+    hb_font_set_variations (cached_fonts[i], &var, 1);
+  }
+  /* The face is in use now. */
+  set_size (cached_face, 0);
+  g_assert_cmpuint (get_size (cached_face), ==, cache_size);
+
+  unsigned glyph_count = hb_face_get_glyph_count (face);
+  for (unsigned pass = 0; pass < 2; pass++)
+  for (hb_codepoint_t gid = 0; gid < glyph_count; gid++)
+  for (unsigned j = 0; j < G_N_ELEMENTS (weights); j++)
+  {
+    /* Rotate the order of instances, to test they don't mix. */
+    unsigned i = (gid + pass + j) % G_N_ELEMENTS (weights);
+    hb_glyph_extents_t extents, cached_extents;
+
+    /* Loads phantom points only; before and after the glyph is decoded. */
+    g_assert_cmpint (hb_font_get_glyph_h_advance (fonts[i], gid), ==,
+		     hb_font_get_glyph_h_advance (cached_fonts[i], gid));
+
+    draw_data.consumed = 0;
+    hb_font_draw_glyph (fonts[i], gid, funcs, &draw_data);
+    draw_data2.consumed = 0;
+    hb_font_draw_glyph (cached_fonts[i], gid, funcs, &draw_data2);
+    g_assert_cmpmem (str, draw_data.consumed, str2, draw_data2.consumed);
+
+    g_assert_cmpint (hb_font_get_glyph_extents (fonts[i], gid, &extents), ==,
+		     hb_font_get_glyph_extents (cached_fonts[i], gid, &cached_extents));
+    g_assert_cmpint (extents.x_bearing, ==, cached_extents.x_bearing);
+    g_assert_cmpint (extents.y_bearing, ==, cached_extents.y_bearing);
+    g_assert_cmpint (extents.width, ==, cached_extents.width);
+    g_assert_cmpint (extents.height, ==, cached_extents.height);
+  }
+
+  if (get_stats)
+  {
+    /* Entries were served from the cache, at least on the second pass. */
+    unsigned hits, misses;
+    get_stats (cached_face, &hits, &misses);
+    g_assert_cmpuint (hits, >, 0);
+    g_assert_cmpuint (misses, >, 0);
+    get_stats (face, &hits, &misses);
+    g_assert_cmpuint (hits, ==, 0);
+    g_assert_cmpuint (misses, ==, 0);
+  }
+
+  for (unsigned i = 0; i < G_N_ELEMENTS (weights); i++)
+  {
+    hb_font_destroy (fonts[i]);
+    hb_font_destroy (cached_fonts[i]);
+  }
+  hb_face_destroy (face);
+  hb_face_destroy (cached_face);
+}
+
+static void
+test_hb_draw_glyf_outline_cache (void)
+{
+  const char *font_files[] = {
+    "fonts/NotoSans-Bold.ttf",
+    "fonts/SourceSansVariable-Roman.modcomp.ttf",
+    "fonts/Roboto-Regular.components.ttf",
+  };
+  /* Small enough for eviction to happen. */
+  unsigned cache_sizes[] = {1 << 12, 1 << 22};
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  for (unsigned c = 0; c < G_N_ELEMENTS (cache_sizes); c++)
+    _test_hb_draw_face_cache (font_files[f], cache_sizes[c],
+			      hb_face_set_glyf_outline_cache_size,
+			      hb_face_get_glyf_outline_cache_size,
+			      hb_face_get_glyf_outline_cache_stats);
+}
+
+static void
+test_hb_draw_gvar_decoded_cache (void)
+{
+  const char *font_files[] = {
+    "fonts/Roboto-Variable.abc.ttf",
+    "fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf",
+    "fonts/Mada-VF.ttf",
+  };
+  /* Small enough to fill up, or to not even cover the glyph slots. */
+  unsigned cache_sizes[] = {1 << 12, 1 << 22};
+
+  for (unsigned f = 0; f < G_N_ELEMENTS (font_files); f++)
+  for (unsigned c = 0; c < G_N_ELEMENTS (cache_sizes); c++)
+    _test_hb_draw_face_cache (font_files[f], cache_sizes[c],
+			      hb_face_set_gvar_decoded_cache_size,
+			      hb_face_get_gvar_decoded_cache_size,
+			      NULL);
+}
+
 static void
 test_hb_draw_funcs (const void* user_data)
 {
@@ -1190,6 +1476,9 @@ main (int argc, char **argv)
   hb_test_add (test_hb_draw_synthetic_slant);
   hb_test_add (test_hb_draw_subfont_scale);
   hb_test_add (test_hb_draw_immutable);
+  hb_test_add (test_hb_draw_glyphs_packed);
+  hb_test_add (test_hb_draw_glyf_outline_cache);
+  hb_test_add (test_hb_draw_gvar_decoded_cache);
 
   const char **font_funcs = hb_font_list_funcs ();
   for (const char **font_funcs_name = font_funcs; *font_funcs_name; font_funcs_name++)
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2026  Google, Inc.
+ *
+ *  This is part of HarfBuzz, a text shaping library.
+ *
+ * Permission is hereby granted, without written agreement and without
+ * license or royalty fees, to use, copy, modify, and distribute this
+ * software and its documentation for any purpose, provided that the
+ * above copyright notice and the following two paragraphs appear in
+ * all copies of this software.
+ *
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE TO ANY PARTY FOR
+ * DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES
+ * ARISING OUT OF THE USE OF THIS SOFTWARE AND ITS DOCUMENTATION, EVEN
+ * IF THE COPYRIGHT HOLDER HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE COPYRIGHT HOLDER SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE.  THE SOFTWARE PROVIDED HEREUNDER IS
+ * ON AN "AS IS" BASIS, AND THE COPYRIGHT HOLDER HAS NO OBLIGATION TO
+ * PROVIDE MAINTENANCE, SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+ */
+
+#include "hb-test.h"
+
+#include <hb.h>
+
+/* Unit tests for hb-executor.h */
+
+typedef struct
+{
+  unsigned calls[8];
+} tasks_t;
+
+static void
+count_task (void *task_data, unsigned int task_index)
+{
+  tasks_t *tasks = (tasks_t *) task_data;
+  g_assert_cmpuint (task_index, <, G_N_ELEMENTS (tasks->calls));
+  tasks->calls[task_index]++;
+}
+
+typedef struct
+{
+  unsigned batches;
+  unsigned destroyed;
+} executor_data_t;
+
+/* Runs tasks in reverse, to make sure nothing relies on the order. */
+static void
+run_reversed (hb_executor_t *executor HB_UNUSED,
+	      hb_executor_task_func_t task,
+	      void *task_data,
+	      unsigned int num_tasks,
+	      void *user_data)
+{
+  executor_data_t *data = (executor_data_t *) user_data;
+  data->batches++;
+  while (num_tasks--)
+    task (task_data, num_tasks);
+}
+
+static void
+destroy_data (void *user_data)
+{
+  executor_data_t *data = (executor_data_t *) user_data;
+  data->destroyed++;
+}
+
+static void
+test_executor_empty (void)
+{
+  hb_executor_t *empty = hb_executor_get_empty ();
+  tasks_t tasks = {{0}};
+  unsigned i;
+
+  hb_executor_run (empty, count_task, &tasks, 5);
+  for (i = 0; i < G_N_ELEMENTS (tasks.calls); i++)
+    g_assert_cmpuint (tasks.calls[i], ==, i < 5 ? 1 : 0);
+
+  g_assert_true (hb_executor_create (NULL, NULL, NULL) == empty);
+
+  hb_executor_destroy (empty);
+}
+
+static void
+test_executor_run (void)
+{
+  executor_data_t data = {0, 0};
+  hb_executor_t *executor = hb_executor_create (run_reversed, &data, destroy_data);
+  tasks_t tasks = {{0}};
+  unsigned i;
+
+  g_assert_true (executor != hb_executor_get_empty ());
+
+  hb_executor_run (executor, count_task, &tasks, 8);
+  g_assert_cmpuint (data.batches, ==, 1);
+  for (i = 0; i < G_N_ELEMENTS (tasks.calls); i++)
+    g_assert_cmpuint (tasks.calls[i], ==, 1);
+
+  /* Empty batches don't reach the callback. */
+  hb_executor_run (executor, count_task, &tasks, 0);
+  g_assert_cmpuint (data.batches, ==, 1);
+
+  hb_executor_reference (executor);
+  hb_executor_destroy (executor);
+  g_assert_cmpuint (data.destroyed, ==, 0);
+  hb_executor_destroy (executor);
+  g_assert_cmpuint (data.destroyed, ==, 1);
+}
+
+static void
+test_executor_userdata (void)
+{
+  static hb_user_data_key_t key;
+  executor_data_t data = {0, 0};
+  hb_executor_t *executor = hb_executor_create (run_reversed, NULL, NULL);
+
+  g_assert_true (hb_executor_set_user_data (executor, &key, &data, destroy_data, true));
+  g_assert_true (hb_executor_get_user_data (executor, &key) == &data);
+
+  hb_executor_destroy (executor);
+  g_assert_cmpuint (data.destroyed, ==, 1);
+}
+
+int
+main (int argc, char **argv)
+{
+  hb_test_init (&argc, &argv);
+
+  hb_test_add (test_executor_empty);
+  hb_test_add (test_executor_run);
+  hb_test_add (test_executor_userdata);
+
+  return hb_test_run();
+}
@@ -435,6 +435,119 @@ test_fontfuncs_subclassing (void)
   hb_font_destroy (font2);
 }
 
+static hb_bool_t
+glyph_extents_func1 (hb_font_t *font HB_UNUSED, void *font_data HB_UNUSED,
+		     hb_codepoint_t glyph,
+		     hb_glyph_extents_t *extents,
+		     void *user_data HB_UNUSED)
+{
+  if (glyph == 1) {
+    extents->x_bearing = 1;
+    extents->y_bearing = 2;
+    extents->width = 3;
+    extents->height = -4;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+static hb_bool_t
+glyph_extents_batch_func1 (hb_font_t *font, void *font_data,
+			   unsigned int count,
+			   const hb_codepoint_t *first_glyph,
+			   unsigned glyph_stride,
+			   hb_glyph_extents_t *first_extents,
+			   unsigned extents_stride,
+			   void *user_data)
+{
+  hb_bool_t ret = TRUE;
+  unsigned i;
+
+  for (i = 0; i < count; i++)
+  {
+    hb_glyph_extents_t *extents = (hb_glyph_extents_t *) ((char *) first_extents + i * extents_stride);
+    hb_codepoint_t glyph = *(const hb_codepoint_t *) ((const char *) first_glyph + i * glyph_stride);
+    memset (extents, 0, sizeof (*extents));
+    if (!glyph_extents_func1 (font, font_data, glyph, extents, user_data))
+      ret = FALSE;
+  }
+
+  return ret;
+}
+
+static void
+_test_font_extents_batch (hb_font_t *font, int x_mult, int y_mult)
+{
+  hb_codepoint_t glyphs[2] = { 1, 2 };
+  hb_glyph_extents_t extents[2];
+
+  g_assert_true (hb_font_get_glyph_extents (font, 1, &extents[0]));
+  g_assert_cmpint (extents[0].x_bearing, ==, 1 * x_mult);
+  g_assert_cmpint (extents[0].height, ==, -4 * y_mult);
+
+  memset (extents, 0x55, sizeof (extents));
+  g_assert_true (hb_font_get_glyph_extents_batch (font, 1,
+						  glyphs, sizeof (glyphs[0]),
+						  extents, sizeof (extents[0])));
+  g_assert_cmpint (extents[0].x_bearing, ==, 1 * x_mult);
+  g_assert_cmpint (extents[0].y_bearing, ==, 2 * y_mult);
+  g_assert_cmpint (extents[0].width, ==, 3 * x_mult);
+  g_assert_cmpint (extents[0].height, ==, -4 * y_mult);
+
+  memset (extents, 0x55, sizeof (extents));
+  g_assert_false (hb_font_get_glyph_extents_batch (font, 2,
+						   glyphs, sizeof (glyphs[0]),
+						   extents, sizeof (extents[0])));
+  g_assert_cmpint (extents[0].width, ==, 3 * x_mult);
+  g_assert_cmpint (extents[1].x_bearing, ==, 0);
+  g_assert_cmpint (extents[1].y_bearing, ==, 0);
+  g_assert_cmpint (extents[1].width, ==, 0);
+  g_assert_cmpint (extents[1].height, ==, 0);
+}
+
+static void
+test_fontfuncs_extents_batch (void)
+{
+  hb_blob_t *blob;
+  hb_face_t *face;
+  hb_font_funcs_t *ffuncs;
+  hb_font_t *font;
+  hb_font_t *subfont;
+  unsigned i;
+
+  blob = hb_blob_create (test_data, sizeof (test_data), HB_MEMORY_MODE_READONLY, NULL, NULL);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+
+  /* Setting either of the single-glyph or the batch callback is enough;
+   * the other one defaults to calling it. */
+  for (i = 0; i < 2; i++)
+  {
+    font = hb_font_create (face);
+    hb_font_set_scale (font, 10, 10);
+
+    ffuncs = hb_font_funcs_create ();
+    if (i == 0)
+      hb_font_funcs_set_glyph_extents_func (ffuncs, glyph_extents_func1, NULL, NULL);
+    else
+      hb_font_funcs_set_glyph_extents_batch_func (ffuncs, glyph_extents_batch_func1, NULL, NULL);
+    hb_font_set_funcs (font, ffuncs, NULL, NULL);
+    hb_font_funcs_destroy (ffuncs);
+
+    _test_font_extents_batch (font, 1, 1);
+
+    subfont = hb_font_create_sub_font (font);
+    hb_font_set_scale (subfont, 20, 30);
+    _test_font_extents_batch (subfont, 2, 3);
+
+    hb_font_destroy (subfont);
+    hb_font_destroy (font);
+  }
+
+  hb_face_destroy (face);
+}
+
 static hb_bool_t
 nominal_glyph_func (hb_font_t *font HB_UNUSED,
 		    void *font_data HB_UNUSED,
@@ -672,6 +785,140 @@ test_font_properties (void)
   hb_font_destroy (subfont);
 }
 
+static void
+_test_font_freeze_shape (hb_font_t *font, hb_font_t *frozen,
+			 hb_direction_t direction,
+			 const hb_feature_t *features, unsigned num_features)
+{
+  hb_buffer_t *buf = hb_buffer_create ();
+  hb_buffer_t *frozen_buf = hb_buffer_create ();
+  unsigned len, frozen_len, i;
+  hb_glyph_info_t *info, *frozen_info;
+  hb_glyph_position_t *pos, *frozen_pos;
+
+  hb_buffer_add_utf8 (buf, "abcabc", -1, 0, -1);
+  hb_buffer_set_direction (buf, direction);
+  hb_buffer_guess_segment_properties (buf);
+  hb_buffer_add_utf8 (frozen_buf, "abcabc", -1, 0, -1);
+  hb_buffer_set_direction (frozen_buf, direction);
+  hb_buffer_guess_segment_properties (frozen_buf);
+
+  hb_shape (font, buf, features, num_features);
+  hb_shape (frozen, frozen_buf, features, num_features);
+
+  info = hb_buffer_get_glyph_infos (buf, &len);
+  pos = hb_buffer_get_glyph_positions (buf, &len);
+  frozen_info = hb_buffer_get_glyph_infos (frozen_buf, &frozen_len);
+  frozen_pos = hb_buffer_get_glyph_positions (frozen_buf, &frozen_len);
+  g_assert_cmpuint (len, ==, frozen_len);
+  for (i = 0; i < len; i++)
+  {
+    hb_glyph_extents_t extents, frozen_extents;
+    hb_position_t x, y, frozen_x, frozen_y;
+
+    g_assert_cmpuint (info[i].codepoint, ==, frozen_info[i].codepoint);
+    g_assert_cmpint (pos[i].x_advance, ==, frozen_pos[i].x_advance);
+    g_assert_cmpint (pos[i].y_advance, ==, frozen_pos[i].y_advance);
+    g_assert_cmpint (pos[i].x_offset, ==, frozen_pos[i].x_offset);
+    g_assert_cmpint (pos[i].y_offset, ==, frozen_pos[i].y_offset);
+
+    g_assert_true (hb_font_get_glyph_extents (font, info[i].codepoint, &extents));
+    g_assert_true (hb_font_get_glyph_extents (frozen, info[i].codepoint, &frozen_extents));
+    g_assert_cmpint (extents.x_bearing, ==, frozen_extents.x_bearing);
+    g_assert_cmpint (extents.y_bearing, ==, frozen_extents.y_bearing);
+    g_assert_cmpint (extents.width, ==, frozen_extents.width);
+    g_assert_cmpint (extents.height, ==, frozen_extents.height);
+
+    hb_font_get_glyph_v_origin (font, info[i].codepoint, &x, &y);
+    hb_font_get_glyph_v_origin (frozen, info[i].codepoint, &frozen_x, &frozen_y);
+    g_assert_cmpint (x, ==, frozen_x);
+    g_assert_cmpint (y, ==, frozen_y);
+  }
+
+  hb_buffer_destroy (buf);
+  hb_buffer_destroy (frozen_buf);
+}
+
+static void
+test_font_freeze (void)
+{
+  const char *font_files[] = {
+    "fonts/Roboto-Variable.abc.ttf",
+    "fonts/SourceSerifVariable-Roman-VVAR.abc.ttf",
+    "fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf",
+  };
+  hb_variation_t variation = {HB_TAG ('w','g','h','t'), 700};
+  hb_font_t *font, *frozen, *subfont;
+  hb_face_t *face;
+  unsigned i;
+
+  /* Freezing the empty font is a no-op. */
+  hb_font_freeze (hb_font_get_empty ());
+
+  for (i = 0; i < G_N_ELEMENTS (font_files); i++)
+  {
+    int variable;
+    for (variable = 0; variable < 2; variable++)
+    {
+      face = hb_test_open_font_file (font_files[i]);
+      font = hb_font_create (face);
+      frozen = hb_font_create (face);
+      if (variable)
+      {
+	hb_font_set_variations (font, &variation, 1);
+	hb_font_set_variations (frozen, &variation, 1);
+      }
+
+      g_assert_true (!hb_font_is_frozen (frozen));
+      hb_font_freeze (frozen);
+      g_assert_true (hb_font_is_frozen (frozen));
+      g_assert_true (hb_font_is_immutable (frozen));
+
+      /* A frozen font ignores changes. */
+      hb_font_set_scale (frozen, 10, 10);
+      hb_font_set_variations (frozen, NULL, 0);
+
+      _test_font_freeze_shape (font, frozen, HB_DIRECTION_LTR, NULL, 0);
+      _test_font_freeze_shape (font, frozen, HB_DIRECTION_TTB, NULL, 0);
+      /* And again, with the caches warm. */
+      _test_font_freeze_shape (font, frozen, HB_DIRECTION_LTR, NULL, 0);
+      _test_font_freeze_shape (font, frozen, HB_DIRECTION_TTB, NULL, 0);
+
+      hb_font_destroy (font);
+      hb_font_destroy (frozen);
+      hb_face_destroy (face);
+    }
+  }
+
+  /* Shaping a frozen font with more feature combinations than it holds
+   * on to, while the shape-plan cache of the face keeps evicting them. */
+  face = hb_test_open_font_file (font_files[0]);
+  hb_shape_plan_cache_set_capacity (face, 1);
+  font = hb_font_create (face);
+  frozen = hb_font_create (face);
+  hb_font_freeze (frozen);
+  for (i = 0; i < 3 * 12; i++)
+  {
+    hb_feature_t feature = {HB_TAG ('s','s','0','1'), 1, 0, (unsigned) -1};
+    feature.value = i % 12;
+    _test_font_freeze_shape (font, frozen, HB_DIRECTION_LTR, &feature, 1);
+  }
+  hb_font_destroy (font);
+  hb_font_destroy (frozen);
+  hb_face_destroy (face);
+
+  /* Freezing a sub-font freezes its parent too. */
+  face = hb_test_open_font_file (font_files[0]);
+  font = hb_font_create (face);
+  subfont = hb_font_create_sub_font (font);
+  hb_font_freeze (subfont);
+  g_assert_true (hb_font_is_frozen (subfont));
+  g_assert_true (hb_font_is_frozen (font));
+  hb_font_destroy (subfont);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -686,9 +933,11 @@ main (int argc, char **argv)
   hb_test_add (test_fontfuncs_nil);
   hb_test_add (test_fontfuncs_subclassing);
   hb_test_add (test_fontfuncs_parallels);
+  hb_test_add (test_fontfuncs_extents_batch);
 
   hb_test_add (test_font_empty);
   hb_test_add (test_font_properties);
+  hb_test_add (test_font_freeze);
 
   return hb_test_run();
 }
@@ -208,6 +208,49 @@ test_extents_cff2_vsindex_named_instance (void)
   hb_font_destroy (font);
 }
 
+static void
+test_extents_cff2_batch (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/AdobeVFPrototype.abc.otf");
+  g_assert_true (face);
+  hb_font_t *font = hb_font_create (face);
+  hb_face_destroy (face);
+  g_assert_true (font);
+
+  hb_codepoint_t glyphs[5] = { 1, 2, 3, 1, 2 };
+  hb_glyph_extents_t batch[5];
+  hb_glyph_extents_t extents;
+  unsigned i;
+
+  g_assert_true (hb_font_get_glyph_extents_batch (font, 5,
+						  glyphs, sizeof (glyphs[0]),
+						  batch, sizeof (batch[0])));
+  for (i = 0; i < 5; i++)
+  {
+    g_assert_true (hb_font_get_glyph_extents (font, glyphs[i], &extents));
+    g_assert_cmpmem (&batch[i], sizeof (batch[i]), &extents, sizeof (extents));
+  }
+  g_assert_cmpint (batch[0].width, ==, 455);
+
+  /* Cached extents must follow scale changes, not just variations. */
+  hb_font_set_scale (font, 2000, 2000);
+  g_assert_true (hb_font_get_glyph_extents (font, 1, &extents));
+  g_assert_cmpint (extents.x_bearing, ==, 92);
+  g_assert_cmpint (extents.width, ==, 910);
+
+  /* Missing glyphs get zeroed extents. */
+  glyphs[1] = 1000;
+  memset (batch, 0xff, sizeof (batch));
+  g_assert_false (hb_font_get_glyph_extents_batch (font, 2,
+						   glyphs, sizeof (glyphs[0]),
+						   batch, sizeof (batch[0])));
+  g_assert_cmpint (batch[0].width, ==, 910);
+  g_assert_cmpint (batch[1].width, ==, 0);
+  g_assert_cmpint (batch[1].height, ==, 0);
+
+  hb_font_destroy (font);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -219,6 +262,7 @@ main (int argc, char **argv)
   hb_test_add (test_extents_cff2);
   hb_test_add (test_extents_cff2_vsindex);
   hb_test_add (test_extents_cff2_vsindex_named_instance);
+  hb_test_add (test_extents_cff2_batch);
 
   return hb_test_run ();
 }
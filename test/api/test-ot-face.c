@@ -50,6 +50,7 @@ test_font (hb_font_t *font, hb_codepoint_t cp)
   hb_face_collect_unicodes (face, set);
   hb_face_collect_variation_selectors (face, set);
   hb_face_collect_variation_unicodes (face, cp, set);
+  hb_face_warm (face, NULL);
 
   hb_font_get_nominal_glyph (font, cp, &g);
   hb_font_get_variation_glyph (font, cp, cp, &g);
@@ -213,6 +214,183 @@ test_ot_var_axis_on_zero_named_instance (void)
   hb_face_destroy (face);
 }
 
+typedef struct
+{
+  unsigned batches;
+  unsigned tasks;
+} warm_executor_data_t;
+
+static void
+run_tasks_counting (hb_executor_t *executor HB_UNUSED,
+		    hb_executor_task_func_t task,
+		    void *task_data,
+		    unsigned int num_tasks,
+		    void *user_data)
+{
+  warm_executor_data_t *data = (warm_executor_data_t *) user_data;
+  unsigned int i;
+  data->batches++;
+  data->tasks += num_tasks;
+  for (i = 0; i < num_tasks; i++)
+    task (task_data, i);
+}
+
+static void
+shape_and_compare (hb_font_t *font, hb_font_t *reference_font, const char *text)
+{
+  hb_buffer_t *buffer = hb_buffer_create ();
+  hb_buffer_t *reference = hb_buffer_create ();
+  hb_glyph_info_t *infos, *reference_infos;
+  hb_glyph_position_t *positions, *reference_positions;
+  unsigned int len, reference_len, i;
+
+  hb_buffer_add_utf8 (buffer, text, -1, 0, -1);
+  hb_buffer_guess_segment_properties (buffer);
+  hb_buffer_add_utf8 (reference, text, -1, 0, -1);
+  hb_buffer_guess_segment_properties (reference);
+
+  hb_shape (font, buffer, NULL, 0);
+  hb_shape (reference_font, reference, NULL, 0);
+
+  infos = hb_buffer_get_glyph_infos (buffer, &len);
+  positions = hb_buffer_get_glyph_positions (buffer, NULL);
+  reference_infos = hb_buffer_get_glyph_infos (reference, &reference_len);
+  reference_positions = hb_buffer_get_glyph_positions (reference, NULL);
+  g_assert_cmpuint (len, ==, reference_len);
+  for (i = 0; i < len; i++)
+  {
+    g_assert_cmpuint (infos[i].codepoint, ==, reference_infos[i].codepoint);
+    g_assert_cmpuint (infos[i].cluster, ==, reference_infos[i].cluster);
+    g_assert_cmpint (positions[i].x_advance, ==, reference_positions[i].x_advance);
+    g_assert_cmpint (positions[i].x_offset, ==, reference_positions[i].x_offset);
+    g_assert_cmpint (positions[i].y_offset, ==, reference_positions[i].y_offset);
+  }
+
+  hb_buffer_destroy (buffer);
+  hb_buffer_destroy (reference);
+}
+
+static void
+test_ot_face_warm (void)
+{
+  const char *text = "\xd9\x84\xd8\xa7 \xd8\xa8\xd9\x86\xd8\xaa";
+  hb_face_t *reference_face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_font_t *reference_font = hb_font_create (reference_face);
+  warm_executor_data_t data = {0, 0};
+  hb_executor_t *executor = hb_executor_create (run_tasks_counting, &data, NULL);
+  hb_segment_properties_t props = HB_SEGMENT_PROPERTIES_DEFAULT;
+  hb_face_t *face;
+  hb_font_t *font;
+
+  face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_face_warm (face, executor);
+  g_assert_cmpuint (data.batches, ==, 1);
+  g_assert_cmpuint (data.tasks, ==,
+		    hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB) +
+		    hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GPOS));
+  font = hb_font_create (face);
+  shape_and_compare (font, reference_font, text);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+
+  face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  font = hb_font_create (face);
+  props.direction = HB_DIRECTION_RTL;
+  props.script = HB_SCRIPT_ARABIC;
+  props.language = hb_language_from_string ("ur", -1);
+  data.batches = data.tasks = 0;
+  hb_font_warm (font, &props, NULL, 0, NULL, executor);
+  g_assert_cmpuint (data.batches, ==, 1);
+  g_assert_cmpuint (data.tasks, >, 0);
+  g_assert_cmpuint (data.tasks, <,
+		    hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GSUB) +
+		    hb_ot_layout_table_get_lookup_count (face, HB_OT_TAG_GPOS));
+  shape_and_compare (font, reference_font, text);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+
+  hb_executor_destroy (executor);
+  hb_font_destroy (reference_font);
+  hb_face_destroy (reference_face);
+}
+
+static void
+test_ot_face_cmap_page_table_font (const char *font_path)
+{
+  hb_face_t *reference_face = hb_test_open_font_file (font_path);
+  hb_font_t *reference_font = hb_font_create (reference_face);
+  hb_face_t *face = hb_test_open_font_file (font_path);
+  hb_font_t *font;
+  hb_codepoint_t unicodes[0x11000];
+  hb_codepoint_t glyphs[0x11000];
+  unsigned count = 0, done = 0;
+  hb_codepoint_t u;
+
+  g_assert_false (hb_face_get_cmap_page_table (face));
+  hb_face_set_cmap_page_table (face, true);
+  g_assert_true (hb_face_get_cmap_page_table (face));
+  g_assert_cmpuint (hb_face_get_cmap_page_table_size (face), ==, 0);
+
+  font = hb_font_create (face);
+  hb_face_set_cmap_page_table (face, false); /* Immutable now. */
+  g_assert_true (hb_face_get_cmap_page_table (face));
+
+  for (u = 0; u < 0x11000; u++)
+  {
+    hb_codepoint_t glyph = 0, reference_glyph = 0;
+    hb_bool_t found = hb_font_get_nominal_glyph (font, u, &glyph);
+    g_assert_cmpint (found, ==, hb_font_get_nominal_glyph (reference_font, u, &reference_glyph));
+    g_assert_cmpuint (glyph, ==, reference_glyph);
+    if (found)
+      unicodes[count++] = u;
+  }
+  g_assert_cmpuint (count, >, 0);
+  g_assert_cmpuint (hb_face_get_cmap_page_table_size (face), >, 0);
+
+  while (done < count)
+  {
+    unsigned n = hb_font_get_nominal_glyphs (font, count - done,
+					     unicodes + done, sizeof (hb_codepoint_t),
+					     glyphs + done, sizeof (hb_codepoint_t));
+    g_assert_cmpuint (n, >, 0);
+    done += n;
+  }
+  for (u = 0; u < count; u++)
+  {
+    hb_codepoint_t reference_glyph = 0;
+    hb_font_get_nominal_glyph (reference_font, unicodes[u], &reference_glyph);
+    g_assert_cmpuint (glyphs[u], ==, reference_glyph);
+  }
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+  hb_font_destroy (reference_font);
+  hb_face_destroy (reference_face);
+}
+
+static void
+test_ot_face_cmap_page_table (void)
+{
+  test_ot_face_cmap_page_table_font ("fonts/Mplus1p-Regular.ttf");
+  test_ot_face_cmap_page_table_font ("fonts/Roboto-Regular.abc.format4.ttf");
+  test_ot_face_cmap_page_table_font ("fonts/Roboto-Regular.abc.cmap-format12-only.ttf");
+}
+
+static void
+test_ot_face_subtable_index (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansPro-Regular.otf");
+
+  /* Built for lookups with many subtables only, once they are used. */
+  g_assert_cmpuint (hb_ot_layout_table_get_subtable_index_size (face, HB_OT_TAG_GPOS), ==, 0);
+  hb_face_warm (face, NULL);
+  g_assert_cmpuint (hb_ot_layout_table_get_subtable_index_size (face, HB_OT_TAG_GPOS), >, 0);
+  g_assert_cmpuint (hb_ot_layout_table_get_subtable_index_size (face, HB_OT_TAG_GSUB), ==, 0);
+  g_assert_cmpuint (hb_ot_layout_table_get_subtable_index_size (face, HB_OT_TAG_GDEF), ==, 0);
+
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -220,6 +398,9 @@ main (int argc, char **argv)
 
   hb_test_add (test_ot_face_empty);
   hb_test_add (test_ot_var_axis_on_zero_named_instance);
+  hb_test_add (test_ot_face_warm);
+  hb_test_add (test_ot_face_cmap_page_table);
+  hb_test_add (test_ot_face_subtable_index);
 
   return hb_test_run();
 }
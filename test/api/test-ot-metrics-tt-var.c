@@ -244,6 +244,177 @@ test_advance_tt_var_gvar_infer (void)
   hb_font_destroy (font);
 }
 
+static void
+_test_advance_tt_var_shared (const char *font_path, unsigned num_glyphs)
+{
+  /* Fonts of one face at the same coordinates share cached advances;
+   * compare them with fonts that each have a face of their own.  Use
+   * more coordinates than the face keeps shared instances for. */
+  float weights[] = { 200.f, 300.f, 400.f, 500.f, 600.f, 700.f, 800.f,
+		      900.f, 250.f, 350.f, 450.f, 550.f, 650.f, 750.f };
+  hb_face_t *shared_face = hb_test_open_font_file (font_path);
+  unsigned i, round, gid;
+
+  for (round = 0; round < 2; round++)
+    for (i = 0; i < G_N_ELEMENTS (weights); i++)
+    {
+      hb_face_t *face = hb_test_open_font_file (font_path);
+      hb_font_t *expected = hb_font_create (face);
+      hb_font_t *font = hb_font_create (shared_face);
+      hb_face_destroy (face);
+
+      hb_font_set_var_coords_design (expected, &weights[i], 1);
+      hb_font_set_var_coords_design (font, &weights[i], 1);
+      /* Shared advances are unscaled. */
+      if (round)
+      {
+	hb_font_set_scale (expected, 2000, 3000);
+	hb_font_set_scale (font, 2000, 3000);
+      }
+
+      for (gid = 0; gid < num_glyphs; gid++)
+      {
+	g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==,
+			 hb_font_get_glyph_h_advance (expected, gid));
+	g_assert_cmpint (hb_font_get_glyph_v_advance (font, gid), ==,
+			 hb_font_get_glyph_v_advance (expected, gid));
+      }
+
+      hb_font_destroy (font);
+      hb_font_destroy (expected);
+    }
+
+  /* Fonts that stay alive keep their instances, while one font moving
+   * through coordinates, like an animated axis, recycles the rest. */
+  {
+    hb_font_t *fonts[G_N_ELEMENTS (weights)];
+    hb_font_t *animated = hb_font_create (shared_face);
+    hb_face_t *face = hb_test_open_font_file (font_path);
+    hb_font_t *expected = hb_font_create (face);
+    hb_face_destroy (face);
+
+    for (i = 0; i < G_N_ELEMENTS (weights); i++)
+    {
+      fonts[i] = hb_font_create (shared_face);
+      hb_font_set_var_coords_design (fonts[i], &weights[i], 1);
+      hb_font_get_glyph_h_advance (fonts[i], 0);
+    }
+    for (round = 0; round < 3; round++)
+      for (i = 0; i < G_N_ELEMENTS (weights); i++)
+      {
+	float weight = weights[i] + 10.f * round + 5.f;
+	hb_font_set_var_coords_design (animated, &weight, 1);
+	hb_font_set_var_coords_design (expected, &weight, 1);
+	for (gid = 0; gid < num_glyphs; gid++)
+	  g_assert_cmpint (hb_font_get_glyph_h_advance (animated, gid), ==,
+			   hb_font_get_glyph_h_advance (expected, gid));
+
+	hb_font_set_var_coords_design (expected, &weights[i], 1);
+	for (gid = 0; gid < num_glyphs; gid++)
+	  g_assert_cmpint (hb_font_get_glyph_h_advance (fonts[i], gid), ==,
+			   hb_font_get_glyph_h_advance (expected, gid));
+      }
+
+    for (i = 0; i < G_N_ELEMENTS (weights); i++)
+      hb_font_destroy (fonts[i]);
+    hb_font_destroy (animated);
+    hb_font_destroy (expected);
+  }
+
+  hb_face_destroy (shared_face);
+}
+
+static void
+test_advance_tt_var_shared (void)
+{
+  _test_advance_tt_var_shared ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf", 4);
+  _test_advance_tt_var_shared ("fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf", 3);
+}
+
+static void
+test_advance_tt_var_set_face (void)
+{
+  /* The font functions hold on to the instance of the face they were
+   * created with; it must outlive the font switching faces. */
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf");
+  hb_face_t *other_face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf");
+  hb_font_t *expected = hb_font_create (other_face);
+  hb_font_t *font = hb_font_create (face);
+  hb_variation_t variation = {HB_TAG ('w','g','h','t'), 700};
+  unsigned gid;
+
+  hb_font_set_variations (font, &variation, 1);
+  hb_font_set_variations (expected, &variation, 1);
+  g_assert_cmpint (hb_font_get_glyph_h_advance (font, 1), ==,
+		   hb_font_get_glyph_h_advance (expected, 1));
+
+  hb_font_set_face (font, other_face);
+  hb_face_destroy (face);
+  hb_ot_font_set_funcs (font);
+  hb_font_set_variations (font, &variation, 1);
+  for (gid = 0; gid < 3; gid++)
+    g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==,
+		     hb_font_get_glyph_h_advance (expected, gid));
+
+  /* And once more, destroying the font last. */
+  face = hb_test_open_font_file ("fonts/SourceSansVariable-Roman-nohvar-41,C1.ttf");
+  hb_font_set_face (font, face);
+  hb_face_destroy (face);
+  hb_font_destroy (font);
+
+  hb_font_destroy (expected);
+  hb_face_destroy (other_face);
+}
+
+static void
+test_advance_tt_var_cache_policy (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/SourceSerifVariable-Roman-VVAR.abc.ttf");
+  hb_font_t *expected = hb_font_create (face);
+  hb_font_t *font = hb_font_create (face);
+  float weight = 700.f;
+  unsigned lookups, misses, gid;
+
+  g_assert_cmpint (hb_font_get_cache_policy (font), ==, HB_FONT_CACHE_POLICY_DEFAULT);
+  hb_font_set_cache_policy (font, HB_FONT_CACHE_POLICY_LARGE);
+  g_assert_cmpint (hb_font_get_cache_policy (font), ==, HB_FONT_CACHE_POLICY_LARGE);
+
+  hb_font_set_var_coords_design (expected, &weight, 1);
+  hb_font_set_var_coords_design (font, &weight, 1);
+
+  for (gid = 0; gid < 4; gid++)
+    g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==,
+		     hb_font_get_glyph_h_advance (expected, gid));
+
+  hb_font_get_advance_cache_stats (font, &lookups, &misses);
+  g_assert_cmpuint (lookups, ==, 4);
+  g_assert_cmpuint (misses, ==, 4);
+
+  for (gid = 0; gid < 4; gid++)
+    g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==,
+		     hb_font_get_glyph_h_advance (expected, gid));
+
+  hb_font_get_advance_cache_stats (font, &lookups, &misses);
+  g_assert_cmpuint (lookups, ==, 8);
+  g_assert_cmpuint (misses, ==, 4);
+
+  /* Changing the policy starts over. */
+  hb_font_set_cache_policy (font, HB_FONT_CACHE_POLICY_DEFAULT);
+  hb_font_get_advance_cache_stats (font, &lookups, &misses);
+  g_assert_cmpuint (lookups, ==, 0);
+  g_assert_cmpuint (misses, ==, 0);
+
+  for (gid = 0; gid < 4; gid++)
+    g_assert_cmpint (hb_font_get_glyph_h_advance (font, gid), ==,
+		     hb_font_get_glyph_h_advance (expected, gid));
+  hb_font_get_advance_cache_stats (font, &lookups, NULL);
+  g_assert_cmpuint (lookups, ==, 4);
+
+  hb_font_destroy (font);
+  hb_font_destroy (expected);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -256,6 +427,9 @@ main (int argc, char **argv)
   hb_test_add (test_extents_tt_var_comp);
   hb_test_add (test_advance_tt_var_comp_v);
   hb_test_add (test_advance_tt_var_gvar_infer);
+  hb_test_add (test_advance_tt_var_shared);
+  hb_test_add (test_advance_tt_var_set_face);
+  hb_test_add (test_advance_tt_var_cache_policy);
 
   return hb_test_run ();
 }
@@ -318,6 +318,72 @@ test_ot_shape_plan_get_feature_tags_userfeatures_disablenondeafult (void)
   hb_face_destroy (face);
 }
 
+static void
+test_shape_plan_cache (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoSans-Bold.ttf");
+  unsigned int num_plans, hits, misses;
+
+  hb_segment_properties_t props = HB_SEGMENT_PROPERTIES_DEFAULT;
+  props.script = HB_SCRIPT_LATIN;
+  props.direction = HB_DIRECTION_LTR;
+
+  hb_feature_t user_features[1] = {{HB_TAG ('s', 'm', 'c', 'p'), 1, 0, (unsigned) -1}};
+
+  hb_shape_plan_t *plan1 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  hb_shape_plan_t *plan2 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  g_assert_true (plan1 == plan2);
+
+  hb_shape_plan_cache_get_stats (face, &num_plans, &hits, &misses);
+  g_assert_cmpuint (num_plans, ==, 1);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 1);
+
+  /* A full cache evicts plans to make room for new ones. */
+  hb_shape_plan_cache_set_capacity (face, 1);
+  hb_shape_plan_t *plan3 = hb_shape_plan_create_cached (face, &props, user_features, 1, NULL);
+  hb_shape_plan_t *plan4 = hb_shape_plan_create_cached (face, &props, user_features, 1, NULL);
+  g_assert_true (plan3 != plan1);
+  g_assert_true (plan3 == plan4);
+
+  hb_shape_plan_cache_get_stats (face, &num_plans, &hits, &misses);
+  g_assert_cmpuint (num_plans, ==, 1);
+  g_assert_cmpuint (hits, ==, 2);
+  g_assert_cmpuint (misses, ==, 2);
+
+  /* Evicted plans stay usable while referenced. */
+  hb_shape_plan_t *plan5 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  g_assert_true (plan5 != plan1);
+  g_assert_cmpstr (hb_shape_plan_get_shaper (plan1), ==, hb_shape_plan_get_shaper (plan5));
+
+  hb_shape_plan_cache_set_capacity (face, 2);
+  hb_shape_plan_t *plan6 = hb_shape_plan_create_cached (face, &props, user_features, 1, NULL);
+  hb_shape_plan_t *plan7 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  g_assert_true (plan6 != plan4);
+  g_assert_true (plan7 == plan5);
+
+  hb_shape_plan_cache_get_stats (face, &num_plans, NULL, NULL);
+  g_assert_cmpuint (num_plans, ==, 2);
+
+  /* Lowering the capacity evicts right away. */
+  hb_shape_plan_cache_set_capacity (face, 0);
+  hb_shape_plan_cache_get_stats (face, &num_plans, NULL, NULL);
+  g_assert_cmpuint (num_plans, ==, 0);
+  hb_shape_plan_t *plan8 = hb_shape_plan_create_cached (face, &props, NULL, 0, NULL);
+  g_assert_true (plan8 != plan7);
+
+  hb_shape_plan_destroy (plan1);
+  hb_shape_plan_destroy (plan2);
+  hb_shape_plan_destroy (plan3);
+  hb_shape_plan_destroy (plan4);
+  hb_shape_plan_destroy (plan5);
+  hb_shape_plan_destroy (plan6);
+  hb_shape_plan_destroy (plan7);
+  hb_shape_plan_destroy (plan8);
+  hb_face_destroy (face);
+}
+
+
 int
 main (int argc, char **argv)
 {
@@ -330,6 +396,7 @@ main (int argc, char **argv)
   hb_test_add (test_ot_shape_plan_get_feature_tags_userfeatures_disable);
   hb_test_add (test_ot_shape_plan_get_feature_tags_userfeatures_disablepartial);
   hb_test_add (test_ot_shape_plan_get_feature_tags_userfeatures_disablenondeafult);
+  hb_test_add (test_shape_plan_cache);
 
   return hb_test_run();
 }
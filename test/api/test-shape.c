@@ -180,6 +180,170 @@ test_shape_clusters (void)
 }
 
 
+static void
+test_shape_batch (void)
+{
+  hb_blob_t *blob;
+  hb_face_t *face;
+  hb_font_funcs_t *ffuncs;
+  hb_font_t *font;
+  hb_buffer_t *buffers[3];
+  unsigned int i;
+
+  blob = hb_blob_create (test_data, sizeof (test_data), HB_MEMORY_MODE_READONLY, NULL, NULL);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  font = hb_font_create (face);
+  hb_face_destroy (face);
+
+  ffuncs = hb_font_funcs_create ();
+  hb_font_funcs_set_glyph_h_advance_func (ffuncs, glyph_h_advance_func, NULL, NULL);
+  hb_font_funcs_set_nominal_glyph_func (ffuncs, glyph_func, NULL, NULL);
+  hb_font_set_funcs (font, ffuncs, NULL, NULL);
+  hb_font_funcs_destroy (ffuncs);
+
+  for (i = 0; i < 3; i++)
+  {
+    buffers[i] = hb_buffer_create ();
+    hb_buffer_set_direction (buffers[i], i == 1 ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
+    hb_buffer_add_utf8 (buffers[i], TesT, 4, 0, i == 2 ? 2 : 4);
+  }
+
+  g_assert_true (hb_shape_batch (font, buffers, 3, NULL, 0, NULL));
+
+  {
+    const hb_codepoint_t output_glyphs[3][4] = {{1, 2, 3, 1}, {1, 3, 2, 1}, {1, 2}};
+    const unsigned int output_lengths[3] = {4, 4, 2};
+    for (i = 0; i < 3; i++)
+    {
+      unsigned int len = hb_buffer_get_length (buffers[i]);
+      hb_glyph_info_t *glyphs = hb_buffer_get_glyph_infos (buffers[i], NULL);
+      unsigned int j;
+      g_assert_cmpint (hb_buffer_get_content_type (buffers[i]), ==, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+      g_assert_cmpint (len, ==, output_lengths[i]);
+      for (j = 0; j < len; j++)
+	g_assert_cmphex (glyphs[j].codepoint, ==, output_glyphs[i][j]);
+      hb_buffer_destroy (buffers[i]);
+    }
+  }
+
+  hb_font_destroy (font);
+}
+
+static hb_position_t
+glyph_h_advance_double_func (hb_font_t *font, void *font_data,
+			     hb_codepoint_t glyph,
+			     void *user_data)
+{
+  return 2 * glyph_h_advance_func (font, font_data, glyph, user_data);
+}
+
+static hb_bool_t
+glyph_counting_func (hb_font_t *font, void *font_data,
+		     hb_codepoint_t unicode,
+		     hb_codepoint_t *glyph,
+		     void *user_data)
+{
+  unsigned int *calls = (unsigned int *) user_data;
+  (*calls)++;
+  return glyph_func (font, font_data, unicode, glyph, NULL);
+}
+
+static void
+shape_cache_check (hb_shape_cache_t *cache,
+		   hb_font_t        *font,
+		   const char       *text,
+		   hb_position_t     advance_scale)
+{
+  const hb_codepoint_t output_glyphs[] = {1, 2, 3, 1};
+  const hb_position_t output_x_advances[] = {10, 6, 5, 10};
+  hb_buffer_t *buffer = hb_buffer_create ();
+  unsigned int len, j;
+  hb_glyph_info_t *glyphs;
+  hb_glyph_position_t *positions;
+
+  hb_buffer_set_direction (buffer, HB_DIRECTION_LTR);
+  hb_buffer_add_utf8 (buffer, text, -1, 0, -1);
+
+  g_assert_true (hb_shape_cache_shape (cache, font, buffer, NULL, 0));
+  g_assert_cmpint (hb_buffer_get_content_type (buffer), ==, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+
+  len = hb_buffer_get_length (buffer);
+  glyphs = hb_buffer_get_glyph_infos (buffer, NULL);
+  positions = hb_buffer_get_glyph_positions (buffer, NULL);
+  g_assert_cmpint (len, ==, strlen (text));
+  for (j = 0; j < len; j++) {
+    g_assert_cmphex (glyphs[j].codepoint, ==, output_glyphs[j]);
+    g_assert_cmphex (glyphs[j].cluster,   ==, j);
+    g_assert_cmpint (positions[j].x_advance, ==, output_x_advances[j] * advance_scale);
+  }
+
+  hb_buffer_destroy (buffer);
+}
+
+static void
+test_shape_cache (void)
+{
+  hb_blob_t *blob;
+  hb_face_t *face;
+  hb_font_funcs_t *ffuncs;
+  hb_font_t *font;
+  hb_shape_cache_t *cache;
+  unsigned int calls = 0, last_calls;
+
+  blob = hb_blob_create (test_data, sizeof (test_data), HB_MEMORY_MODE_READONLY, NULL, NULL);
+  face = hb_face_create (blob, 0);
+  hb_blob_destroy (blob);
+  font = hb_font_create (face);
+  hb_face_destroy (face);
+  hb_font_set_scale (font, 10, 10);
+
+  ffuncs = hb_font_funcs_create ();
+  hb_font_funcs_set_glyph_h_advance_func (ffuncs, glyph_h_advance_func, NULL, NULL);
+  hb_font_funcs_set_nominal_glyph_func (ffuncs, glyph_counting_func, &calls, NULL);
+  hb_font_set_funcs (font, ffuncs, NULL, NULL);
+  hb_font_funcs_destroy (ffuncs);
+
+  cache = hb_shape_cache_create (16);
+  g_assert_true (cache != hb_shape_cache_get_empty ());
+
+  /* The second time is served from the cache, without calling into the font. */
+  shape_cache_check (cache, font, TesT, 1);
+  g_assert_cmpuint (calls, >, 0);
+  last_calls = calls;
+  shape_cache_check (cache, font, TesT, 1);
+  g_assert_cmpuint (calls, ==, last_calls);
+
+  /* Different buffer contents are shaped anew. */
+  shape_cache_check (cache, font, "Tes", 1);
+  g_assert_cmpuint (calls, >, last_calls);
+  last_calls = calls;
+  shape_cache_check (cache, font, "Tes", 1);
+  g_assert_cmpuint (calls, ==, last_calls);
+
+  /* Changing the font invalidates the cached results. */
+  ffuncs = hb_font_funcs_create ();
+  hb_font_funcs_set_glyph_h_advance_func (ffuncs, glyph_h_advance_double_func, NULL, NULL);
+  hb_font_funcs_set_nominal_glyph_func (ffuncs, glyph_counting_func, &calls, NULL);
+  hb_font_set_funcs (font, ffuncs, NULL, NULL);
+  hb_font_funcs_destroy (ffuncs);
+  shape_cache_check (cache, font, TesT, 2);
+  g_assert_cmpuint (calls, >, last_calls);
+  last_calls = calls;
+  shape_cache_check (cache, font, TesT, 2);
+  g_assert_cmpuint (calls, ==, last_calls);
+
+  /* So does changing a font property the funcs don't see. */
+  hb_font_set_scale (font, 20, 20);
+  shape_cache_check (cache, font, TesT, 2);
+  g_assert_cmpuint (calls, >, last_calls);
+
+  hb_shape_cache_clear (cache);
+  hb_shape_cache_destroy (cache);
+  hb_font_destroy (font);
+}
+
+
 static void
 test_shape_list (void)
 {
@@ -200,6 +364,8 @@ main (int argc, char **argv)
 
   hb_test_add (test_shape);
   hb_test_add (test_shape_clusters);
+  hb_test_add (test_shape_batch);
+  hb_test_add (test_shape_cache);
   /* TODO test fallback shaper */
   /* TODO test shaper_full */
   hb_test_add (test_shape_list);
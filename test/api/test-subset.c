@@ -125,6 +125,59 @@ test_subset_set_flags (void)
   hb_subset_input_destroy (input);
 }
 
+/* Runs tasks in reverse, to make sure the subset doesn't depend on
+ * the order tables are subset in. */
+static void
+run_tasks_reversed (hb_executor_t *executor HB_UNUSED,
+		    hb_executor_task_func_t task,
+		    void *task_data,
+		    unsigned int num_tasks,
+		    void *user_data)
+{
+  unsigned *batches = (unsigned *) user_data;
+  (*batches)++;
+  while (num_tasks--)
+    task (task_data, num_tasks);
+}
+
+static void
+test_subset_executor (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/NotoNastaliqUrdu-Regular.ttf");
+  hb_subset_input_t *input = hb_subset_input_create_or_fail ();
+  unsigned batches = 0;
+  hb_executor_t *executor = hb_executor_create (run_tasks_reversed, &batches, NULL);
+  hb_face_t *expected, *actual;
+  hb_blob_t *expected_blob, *actual_blob;
+
+  hb_set_add_range (hb_subset_input_unicode_set (input), 0x0600, 0x06FF);
+
+  g_assert_true (hb_subset_input_get_executor (input) == hb_executor_get_empty ());
+  expected = hb_subset_or_fail (face, input);
+  g_assert_nonnull (expected);
+
+  hb_subset_input_set_executor (input, executor);
+  g_assert_true (hb_subset_input_get_executor (input) == executor);
+  actual = hb_subset_or_fail (face, input);
+  g_assert_nonnull (actual);
+  g_assert_cmpuint (batches, >, 1);
+
+  expected_blob = hb_face_reference_blob (expected);
+  actual_blob = hb_face_reference_blob (actual);
+  hb_test_assert_blobs_equal (expected_blob, actual_blob);
+
+  hb_subset_input_set_executor (input, NULL);
+  g_assert_true (hb_subset_input_get_executor (input) == hb_executor_get_empty ());
+
+  hb_blob_destroy (expected_blob);
+  hb_blob_destroy (actual_blob);
+  hb_face_destroy (expected);
+  hb_face_destroy (actual);
+  hb_executor_destroy (executor);
+  hb_subset_input_destroy (input);
+  hb_face_destroy (face);
+}
+
 
 static void
 test_subset_sets (void)
@@ -412,6 +465,7 @@ main (int argc, char **argv)
   hb_test_add (test_subset_no_inf_loop);
   hb_test_add (test_subset_crash);
   hb_test_add (test_subset_set_flags);
+  hb_test_add (test_subset_executor);
   hb_test_add (test_subset_sets);
   hb_test_add (test_subset_plan);
   hb_test_add (test_subset_create_for_tables_face);
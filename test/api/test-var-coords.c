@@ -76,11 +76,170 @@ test_get_var_get_axis_infos (void)
   hb_face_destroy (face);
 }
 
+typedef struct
+{
+  unsigned verbs;
+  unsigned count;
+  float coords[4096];
+} record_t;
+
+static void
+record (record_t *r, float x, float y)
+{
+  r->verbs++;
+  if (r->count + 2 <= G_N_ELEMENTS (r->coords))
+  {
+    r->coords[r->count++] = x;
+    r->coords[r->count++] = y;
+  }
+}
+
+static void
+record_move_to (hb_draw_funcs_t *dfuncs HB_UNUSED, void *data,
+		hb_draw_state_t *st HB_UNUSED,
+		float to_x, float to_y,
+		void *user_data HB_UNUSED)
+{ record (data, to_x, to_y); }
+
+static void
+record_quadratic_to (hb_draw_funcs_t *dfuncs HB_UNUSED, void *data,
+		     hb_draw_state_t *st HB_UNUSED,
+		     float control_x, float control_y,
+		     float to_x, float to_y,
+		     void *user_data HB_UNUSED)
+{
+  record (data, control_x, control_y);
+  record (data, to_x, to_y);
+}
+
+static void
+record_cubic_to (hb_draw_funcs_t *dfuncs HB_UNUSED, void *data,
+		 hb_draw_state_t *st HB_UNUSED,
+		 float control1_x, float control1_y,
+		 float control2_x, float control2_y,
+		 float to_x, float to_y,
+		 void *user_data HB_UNUSED)
+{
+  record (data, control1_x, control1_y);
+  record (data, control2_x, control2_y);
+  record (data, to_x, to_y);
+}
+
+static void
+record_close_path (hb_draw_funcs_t *dfuncs HB_UNUSED, void *data,
+		   hb_draw_state_t *st HB_UNUSED,
+		   void *user_data HB_UNUSED)
+{ ((record_t *) data)->verbs++; }
+
+static void
+check_blend (const char *font_path, hb_tag_t axis_tag,
+	     float min_value, float max_value)
+{
+  hb_face_t *face = hb_test_open_font_file (font_path);
+  hb_font_t *font = hb_font_create (face);
+  hb_font_t *direct = hb_font_create (face);
+  hb_draw_funcs_t *funcs = hb_draw_funcs_create ();
+  hb_draw_funcs_set_move_to_func (funcs, record_move_to, NULL, NULL);
+  hb_draw_funcs_set_line_to_func (funcs, (hb_draw_line_to_func_t) record_move_to, NULL, NULL);
+  hb_draw_funcs_set_quadratic_to_func (funcs, record_quadratic_to, NULL, NULL);
+  hb_draw_funcs_set_cubic_to_func (funcs, record_cubic_to, NULL, NULL);
+  hb_draw_funcs_set_close_path_func (funcs, record_close_path, NULL, NULL);
+  hb_draw_funcs_make_immutable (funcs);
+
+  unsigned glyph_count = hb_face_get_glyph_count (face);
+  hb_codepoint_t *glyphs = g_new0 (hb_codepoint_t, glyph_count);
+  for (unsigned i = 0; i < glyph_count; i++)
+    glyphs[i] = i;
+
+  hb_ot_var_blend_t *blend = hb_ot_var_blend_create (font, axis_tag,
+						     max_value, min_value,
+						     glyphs, glyph_count);
+  g_assert_true (blend != hb_ot_var_blend_get_empty ());
+  g_assert_cmpuint (hb_ot_var_blend_get_sample_count (blend), >=, 2);
+
+  static record_t a, b;
+  for (unsigned step = 0; step <= 16; step++)
+  {
+    float value = min_value + (max_value - min_value) * step / 16;
+    hb_variation_t variation = {axis_tag, value};
+    hb_font_set_variations (direct, &variation, 1);
+
+    for (unsigned i = 0; i < glyph_count; i++)
+    {
+      hb_position_t advance = hb_font_get_glyph_h_advance (direct, i);
+      hb_position_t blended = hb_ot_var_blend_get_glyph_h_advance (blend, i, value);
+      g_assert_cmpint (abs (advance - blended), <=, 1);
+      advance = hb_font_get_glyph_v_advance (direct, i);
+      blended = hb_ot_var_blend_get_glyph_v_advance (blend, i, value);
+      g_assert_cmpint (abs (advance - blended), <=, 1);
+
+      memset (&a, 0, sizeof (a));
+      memset (&b, 0, sizeof (b));
+      hb_font_draw_glyph (direct, i, funcs, &a);
+      g_assert_true (hb_ot_var_blend_draw_glyph (blend, i, value, funcs, &b));
+      g_assert_cmpuint (a.verbs, ==, b.verbs);
+      g_assert_cmpuint (a.count, ==, b.count);
+      for (unsigned j = 0; j < a.count; j++)
+	g_assert_cmpfloat_with_epsilon (a.coords[j], b.coords[j], 1.f);
+    }
+  }
+
+  /* Values outside the range are clamped to it. */
+  g_assert_cmpint (hb_ot_var_blend_get_glyph_h_advance (blend, 1, max_value + 100),
+		   ==,
+		   hb_ot_var_blend_get_glyph_h_advance (blend, 1, max_value));
+
+  /* Glyphs not sampled. */
+  g_assert_cmpint (hb_ot_var_blend_get_glyph_h_advance (blend, glyph_count, min_value), ==, 0);
+  g_assert_false (hb_ot_var_blend_draw_glyph (blend, glyph_count, min_value, funcs, &b));
+
+  hb_ot_var_blend_destroy (blend);
+  g_free (glyphs);
+  hb_draw_funcs_destroy (funcs);
+  hb_font_destroy (direct);
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
+static void
+test_ot_var_blend (void)
+{
+  check_blend ("fonts/Roboto-Variable.abc.ttf", HB_TAG ('w','g','h','t'), 100, 900);
+  check_blend ("fonts/Roboto-Variable.abc.ttf", HB_TAG ('w','d','t','h'), 80, 95);
+  check_blend ("fonts/Mada-VF.ttf", HB_TAG ('w','g','h','t'), 300, 700);
+  check_blend ("fonts/TestCFF2VF.otf", HB_TAG ('w','g','h','t'), 250, 800);
+}
+
+static void
+test_ot_var_blend_empty (void)
+{
+  hb_face_t *face = hb_test_open_font_file ("fonts/Roboto-Variable.abc.ttf");
+  hb_font_t *font = hb_font_create (face);
+  hb_codepoint_t glyph = 1;
+
+  hb_ot_var_blend_t *blend = hb_ot_var_blend_create (font, HB_TAG ('s','l','n','t'), 0, 10, &glyph, 1);
+  g_assert_true (blend == hb_ot_var_blend_get_empty ());
+  g_assert_cmpuint (hb_ot_var_blend_get_sample_count (blend), ==, 0);
+  g_assert_cmpint (hb_ot_var_blend_get_glyph_h_advance (blend, glyph, 5), ==, 0);
+  hb_ot_var_blend_destroy (blend);
+
+  int normalized_coords[] = {100, 0};
+  hb_font_set_var_coords_normalized (font, normalized_coords, 2);
+  blend = hb_ot_var_blend_create (font, HB_TAG ('w','g','h','t'), 100, 900, &glyph, 1);
+  g_assert_true (blend == hb_ot_var_blend_get_empty ());
+  hb_ot_var_blend_destroy (blend);
+
+  hb_font_destroy (font);
+  hb_face_destroy (face);
+}
+
 int
 main (int argc, char **argv)
 {
   hb_test_init (&argc, &argv);
   hb_test_add (test_get_var_coords);
   hb_test_add (test_get_var_get_axis_infos);
+  hb_test_add (test_ot_var_blend);
+  hb_test_add (test_ot_var_blend_empty);
   return hb_test_run ();
 }
@@ -0,0 +1,228 @@
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hb.h"
+
+/* Measures how font-functions backends scale when many threads share one
+ * font, by shaping and fetching glyph extents on all threads at once.  Each
+ * thread checks its results against those of a single thread. */
+
+#define SUBSET_FONT_BASE_PATH "test/subset/data/fonts/"
+
+struct test_input_t
+{
+  const char *font_path;
+  const char *text_path;
+} default_tests[] =
+{
+
+  {"perf/fonts/Roboto-Regular.ttf",
+   "perf/texts/en-words.txt"},
+
+  {SUBSET_FONT_BASE_PATH "NotoSansDevanagari-Regular.ttf",
+   "perf/texts/hi-words.txt"},
+
+  {"perf/fonts/NotoNastaliqUrdu-Regular.ttf",
+   "perf/texts/fa-thelittleprince.txt"},
+};
+
+
+static test_input_t *tests = default_tests;
+static unsigned num_tests = sizeof (default_tests) / sizeof (default_tests[0]);
+
+// https://en.cppreference.com/w/cpp/thread/condition_variable/wait
+static std::condition_variable cv;
+static std::mutex cv_m;
+static bool ready = false;
+
+static unsigned num_repetitions = 1;
+static unsigned num_threads = 3;
+
+struct lines_t
+{
+  std::vector<std::pair<unsigned, unsigned>> spans; /* Offset and length. */
+  hb_blob_t *blob = nullptr;
+  const char *text = nullptr;
+};
+
+static void load_lines (const char *text_path, lines_t *lines)
+{
+  lines->blob = hb_blob_create_from_file_or_fail (text_path);
+  assert (lines->blob);
+  unsigned text_length;
+  lines->text = hb_blob_get_data (lines->blob, &text_length);
+
+  const char *text = lines->text;
+  const char *end;
+  while ((end = (const char *) memchr (text, '\n', text_length)))
+  {
+    lines->spans.push_back ({(unsigned) (text - lines->text), (unsigned) (end - text)});
+    unsigned skip = end - text + 1;
+    text_length -= skip;
+    text += skip;
+  }
+}
+
+/* Shapes every line, and fetches the extents of its glyphs; returns a
+ * checksum of all results. */
+static unsigned run (const lines_t &lines, hb_font_t *font, hb_buffer_t *buf)
+{
+  unsigned sum = 0;
+  for (const auto &span : lines.spans)
+  {
+    hb_buffer_clear_contents (buf);
+    hb_buffer_add_utf8 (buf, lines.text + span.first, span.second, 0, span.second);
+    hb_buffer_guess_segment_properties (buf);
+    hb_shape (font, buf, nullptr, 0);
+
+    unsigned len;
+    hb_glyph_info_t *info = hb_buffer_get_glyph_infos (buf, &len);
+    hb_glyph_position_t *pos = hb_buffer_get_glyph_positions (buf, &len);
+    for (unsigned i = 0; i < len; i++)
+    {
+      hb_glyph_extents_t extents = {0, 0, 0, 0};
+      hb_font_get_glyph_extents (font, info[i].codepoint, &extents);
+      sum = sum * 31 + info[i].codepoint;
+      sum = sum * 31 + pos[i].x_advance;
+      sum = sum * 31 + pos[i].x_offset;
+      sum = sum * 31 + pos[i].y_offset;
+      sum = sum * 31 + extents.x_bearing + extents.width;
+      sum = sum * 31 + extents.y_bearing + extents.height;
+    }
+  }
+  return sum;
+}
+
+static void thread_func (const lines_t &lines,
+			 hb_font_t *font,
+			 unsigned expected)
+{
+  // Wait till all threads are ready.
+  {
+    std::unique_lock<std::mutex> lk (cv_m);
+    cv.wait(lk, [] {return ready;});
+  }
+
+  hb_buffer_t *buf = hb_buffer_create ();
+  for (unsigned i = 0; i < num_repetitions; i++)
+  {
+    unsigned sum = run (lines, font, buf);
+    assert (sum == expected);
+    (void) sum;
+  }
+  hb_buffer_destroy (buf);
+}
+
+static void test_backend (const char *backend,
+			  const test_input_t &test_input)
+{
+  char name[1024] = "font";
+  const char *p;
+  strcat (name, "/");
+  p = strrchr (test_input.font_path, '/');
+  strcat (name, p ? p + 1 : test_input.font_path);
+  strcat (name, "/");
+  p = strrchr (test_input.text_path, '/');
+  strcat (name, p ? p + 1 : test_input.text_path);
+  strcat (name, "/");
+  strcat (name, backend);
+
+  lines_t lines;
+  load_lines (test_input.text_path, &lines);
+
+  unsigned expected;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    hb_font_t *font = hb_font_create (face);
+    hb_face_destroy (face);
+    bool ret = hb_font_set_funcs_using (font, backend);
+    assert (ret);
+    (void) ret;
+
+    hb_buffer_t *buf = hb_buffer_create ();
+    expected = run (lines, font, buf);
+    hb_buffer_destroy (buf);
+    hb_font_destroy (font);
+  }
+
+  hb_font_t *font;
+  {
+    hb_blob_t *blob = hb_blob_create_from_file_or_fail (test_input.font_path);
+    assert (blob);
+    hb_face_t *face = hb_face_create (blob, 0);
+    hb_blob_destroy (blob);
+    font = hb_font_create (face);
+    hb_face_destroy (face);
+  }
+
+  bool ret = hb_font_set_funcs_using (font, backend);
+  assert (ret);
+  (void) ret;
+
+  ready = false;
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; i++)
+    threads.push_back (std::thread (thread_func, std::cref (lines), font, expected));
+
+  auto start = std::chrono::steady_clock::now ();
+  {
+    std::unique_lock<std::mutex> lk (cv_m);
+    ready = true;
+  }
+  cv.notify_all();
+
+  for (unsigned i = 0; i < num_threads; i++)
+    threads[i].join ();
+  auto end = std::chrono::steady_clock::now ();
+
+  double seconds = std::chrono::duration<double> (end - start).count ();
+  double lines_per_second = (double) lines.spans.size () * num_repetitions * num_threads / seconds;
+  printf ("%-60s %12.0f lines/s\n", name, lines_per_second);
+
+  hb_font_destroy (font);
+  hb_blob_destroy (lines.blob);
+}
+
+int main(int argc, char** argv)
+{
+  if (argc > 1)
+    num_threads = atoi (argv[1]);
+  if (argc > 2)
+    num_repetitions = atoi (argv[2]);
+
+  /* Dummy call to alleviate _guess_segment_properties thread safety-ness
+   * https://github.com/harfbuzz/harfbuzz/issues/1191 */
+  hb_language_get_default ();
+
+  if (argc > 4)
+  {
+    num_tests = (argc - 3) / 2;
+    tests = (test_input_t *) calloc (num_tests, sizeof (test_input_t));
+    for (unsigned i = 0; i < num_tests; i++)
+    {
+      tests[i].font_path = argv[3 + i * 2];
+      tests[i].text_path = argv[4 + i * 2];
+    }
+  }
+
+  printf ("Num threads %u; num repetitions %u\n", num_threads, num_repetitions);
+  for (unsigned i = 0; i < num_tests; i++)
+    for (const char **font_funcs = hb_font_list_funcs (); *font_funcs; font_funcs++)
+      test_backend (*font_funcs, tests[i]);
+
+  if (tests != default_tests)
+    free (tests);
+}
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -47,8 +49,10 @@ static bool ready = false;
 static unsigned num_repetitions = 1;
 static unsigned num_threads = 3;
 
-static void shape (const test_input_t &input,
-		   hb_font_t *font)
+/* Shapes the text num_repetitions times; returns the number of lines
+ * per repetition. */
+static unsigned shape (const test_input_t &input,
+		       hb_font_t *font)
 {
   // Wait till all threads are ready.
   {
@@ -65,10 +69,12 @@ static void shape (const test_input_t &input,
   unsigned orig_text_length;
   const char *orig_text = hb_blob_get_data (text_blob, &orig_text_length);
 
+  unsigned num_lines = 0;
   hb_buffer_t *buf = hb_buffer_create ();
   hb_buffer_set_flags (buf, HB_BUFFER_FLAG_VERIFY);
   for (unsigned i = 0; i < num_repetitions; i++)
   {
+    num_lines = 0;
     unsigned text_length = orig_text_length;
     const char *text = orig_text;
 
@@ -80,6 +86,7 @@ static void shape (const test_input_t &input,
       hb_buffer_guess_segment_properties (buf);
       hb_buffer_set_language (buf, language);
       hb_shape (font, buf, nullptr, 0);
+      num_lines++;
 
       unsigned skip = end - text + 1;
       text_length -= skip;
@@ -89,10 +96,20 @@ static void shape (const test_input_t &input,
   hb_buffer_destroy (buf);
 
   hb_blob_destroy (text_blob);
+
+  return num_lines;
+}
+
+static void shape_thread (const test_input_t &input,
+			  hb_font_t *font,
+			  unsigned *num_lines)
+{
+  *num_lines = shape (input, font);
 }
 
 static void test_backend (const char *backend,
 			  bool variable,
+			  bool frozen,
 			  const test_input_t &test_input)
 {
   char name[1024] = "shape";
@@ -104,6 +121,7 @@ static void test_backend (const char *backend,
   p = strrchr (test_input.text_path, '/');
   strcat (name, p ? p + 1 : test_input.text_path);
   strcat (name, variable ? "/var" : "");
+  strcat (name, frozen ? "/frozen" : "");
   strcat (name, "/");
   strcat (name, backend);
 
@@ -128,18 +146,39 @@ static void test_backend (const char *backend,
   bool ret = hb_font_set_funcs_using (font, backend);
   assert (ret);
 
-  std::vector<std::thread> threads;
-  for (unsigned i = 0; i < num_threads; i++)
-    threads.push_back (std::thread (shape, test_input, font));
+  if (frozen)
+    hb_font_freeze (font);
 
+  /* Measure how shaping scales, doubling the number of threads up
+   * to num_threads. */
+  for (unsigned n = 1; ; n = std::min (n * 2, num_threads))
   {
-    std::unique_lock<std::mutex> lk (cv_m);
-    ready = true;
-  }
-  cv.notify_all();
+    std::vector<std::thread> threads;
+    std::vector<unsigned> num_lines (n);
+    ready = false;
+    for (unsigned i = 0; i < n; i++)
+      threads.push_back (std::thread (shape_thread, test_input, font, &num_lines[i]));
 
-  for (unsigned i = 0; i < num_threads; i++)
-    threads[i].join ();
+    auto start = std::chrono::steady_clock::now ();
+    {
+      std::unique_lock<std::mutex> lk (cv_m);
+      ready = true;
+    }
+    cv.notify_all();
+
+    for (unsigned i = 0; i < n; i++)
+      threads[i].join ();
+    auto end = std::chrono::steady_clock::now ();
+
+    double seconds = std::chrono::duration<double> (end - start).count ();
+    double lines = 0;
+    for (unsigned i = 0; i < n; i++)
+      lines += (double) num_lines[i] * num_repetitions;
+    printf ("  %3u threads: %10.0f lines/s\n", n, lines / seconds);
+
+    if (n >= num_threads)
+      break;
+  }
 
   hb_font_destroy (font);
 }
@@ -176,7 +215,8 @@ int main(int argc, char** argv)
       bool is_var = (bool) variable;
 
       for (const char **font_funcs = hb_font_list_funcs (); *font_funcs; font_funcs++)
-	test_backend (*font_funcs, is_var, test_input);
+	for (int frozen = 0; frozen < 2; frozen++)
+	  test_backend (*font_funcs, is_var, frozen, test_input);
     }
   }
 
@@ -70,6 +70,19 @@ static void AddGlyphs(unsigned num_glyphs_in_font,
   }
 }
 
+static void run_tasks_on_threads (hb_executor_t *,
+				  hb_executor_task_func_t task,
+				  void *task_data,
+				  unsigned num_tasks,
+				  void *)
+{
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < num_tasks; i++)
+    workers.push_back (std::thread (task, task_data, i));
+  for (auto &worker : workers)
+    worker.join ();
+}
+
 static void subset (operation_t operation,
                     const test_input_t &test_input,
                     hb_face_t *face)
@@ -111,6 +124,29 @@ static void subset (operation_t operation,
     hb_face_destroy (subset);
   }
 
+  // Subsetting tables concurrently must produce the same font.
+  {
+    hb_face_t* expected = hb_subset_or_fail (face, input);
+    hb_executor_t* executor = hb_executor_create (run_tasks_on_threads, nullptr, nullptr);
+    hb_subset_input_set_executor (input, executor);
+    hb_executor_destroy (executor);
+    hb_face_t* actual = hb_subset_or_fail (face, input);
+    assert (expected && actual);
+
+    hb_blob_t* expected_blob = hb_face_reference_blob (expected);
+    hb_blob_t* actual_blob = hb_face_reference_blob (actual);
+    unsigned expected_length, actual_length;
+    const char *expected_data = hb_blob_get_data (expected_blob, &expected_length);
+    const char *actual_data = hb_blob_get_data (actual_blob, &actual_length);
+    assert (expected_length == actual_length);
+    assert (!memcmp (expected_data, actual_data, expected_length));
+
+    hb_blob_destroy (expected_blob);
+    hb_blob_destroy (actual_blob);
+    hb_face_destroy (expected);
+    hb_face_destroy (actual);
+  }
+
   hb_subset_input_destroy (input);
 }
 